@@ -23,11 +23,6 @@ AAmmo::AAmmo()
 	AmmoCollisionSphere->SetSphereRadius(50.f);
 }
 
-void AAmmo::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 void AAmmo::BeginPlay()
 {
 	Super::BeginPlay();
@@ -18,7 +18,6 @@ class ULTIMATESHOOTER_API AAmmo : public AItem
 public:
 
 	AAmmo();
-	virtual void Tick(float DeltaTime) override;
 
 protected:
 
@@ -5,6 +5,7 @@ enum class EAmmoType : uint8
 {
 	EAT_9mm UMETA(DisplayName = "9mmm"),
 	EAT_AR UMETA(DisplayName = "AssaultRifle"),
+	EAT_Shells UMETA(DisplayName = "Shells"),
 
 	EAT_MAX UMETA(DisplayName = "DefaultMAX")
 };
\ No newline at end of file
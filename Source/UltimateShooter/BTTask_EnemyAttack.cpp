@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_EnemyAttack.h"
+#include "Enemy.h"
+#include "AIController.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+UBTTask_EnemyAttack::UBTTask_EnemyAttack()
+{
+	NodeName = TEXT("Enemy Attack");
+
+	// Only ticks while waiting for the montage, a finished task isn't ticked
+	bNotifyTick = true;
+}
+
+EBTNodeResult::Type UBTTask_EnemyAttack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* AIController = OwnerComp.GetAIOwner();
+	AEnemy* Enemy = AIController ? Cast<AEnemy>(AIController->GetPawn()) : nullptr;
+	if (!Enemy) return EBTNodeResult::Failed;
+
+	const FName Section{ Enemy->GetAttackSectionName() };
+	Enemy->PlayAttackMontage(Section, PlayRate);
+
+	UAnimMontage* AttackMontage = Enemy->GetAttackMontage();
+	if (!bWaitForMontage || !AttackMontage) return EBTNodeResult::Succeeded;
+
+	FBTEnemyAttackMemory* Memory = reinterpret_cast<FBTEnemyAttackMemory*>(NodeMemory);
+	const int32 SectionIndex{ AttackMontage->GetSectionIndex(Section) };
+	const float SectionLength{ SectionIndex != INDEX_NONE ? AttackMontage->GetSectionLength(SectionIndex) : AttackMontage->GetPlayLength() };
+	Memory->TimeLeft = SectionLength / PlayRate + AttackMontage->BlendOut.GetBlendTime();
+	return EBTNodeResult::InProgress;
+}
+
+void UBTTask_EnemyAttack::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	FBTEnemyAttackMemory* Memory = reinterpret_cast<FBTEnemyAttackMemory*>(NodeMemory);
+	Memory->TimeLeft -= DeltaSeconds;
+
+	AAIController* AIController = OwnerComp.GetAIOwner();
+	const AEnemy* Enemy = AIController ? Cast<AEnemy>(AIController->GetPawn()) : nullptr;
+	const UAnimInstance* AnimInstance = Enemy ? Enemy->GetMesh()->GetAnimInstance() : nullptr;
+
+	if (!AnimInstance || !AnimInstance->Montage_IsPlaying(Enemy->GetAttackMontage()) || Memory->TimeLeft <= 0.f)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
+
+uint16 UBTTask_EnemyAttack::GetInstanceMemorySize() const
+{
+	return sizeof(FBTEnemyAttackMemory);
+}
+
+FString UBTTask_EnemyAttack::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("Random attack section at %.2fx%s"), PlayRate, bWaitForMontage ? TEXT(", waits for the montage") : TEXT(""));
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_EnemyAttack.generated.h"
+
+/** Per agent state of the attack task */
+struct FBTEnemyAttackMemory
+{
+	/** Seconds until the attack counts as finished even if the montage is still playing */
+	float TimeLeft;
+};
+
+/**
+ * Native BTT_Attack: plays a random attack section of the controlled enemy.
+ * Finishes right away like the Blueprint task, or when the attack montage ends if bWaitForMontage is set.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UBTTask_EnemyAttack : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+
+	UBTTask_EnemyAttack();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+
+	UPROPERTY(EditAnywhere, Category = "Attack", meta = (ClampMin = "0.1"))
+	float PlayRate = 1.f;
+
+	/** Stay in progress until the attack montage stops playing */
+	UPROPERTY(EditAnywhere, Category = "Attack")
+	bool bWaitForMontage = false;
+};
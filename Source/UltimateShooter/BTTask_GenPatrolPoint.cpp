@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_GenPatrolPoint.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "PatrolRouteSubsystem.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+
+UBTTask_GenPatrolPoint::UBTTask_GenPatrolPoint()
+{
+	NodeName = TEXT("Generate Patrol Point");
+
+	PatrolPointKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_GenPatrolPoint, PatrolPointKey));
+	PatrolPointKey.AllowNoneAsValue(true);
+}
+
+EBTNodeResult::Type UBTTask_GenPatrolPoint::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* AIController = OwnerComp.GetAIOwner();
+	const APawn* Pawn = AIController ? AIController->GetPawn() : nullptr;
+	UNavigationSystemV1* NavSys = Pawn ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(Pawn->GetWorld()) : nullptr;
+	if (!NavSys) return EBTNodeResult::Failed;
+
+	FBTGenPatrolPointMemory* Memory = reinterpret_cast<FBTGenPatrolPointMemory*>(NodeMemory);
+	const FVector Origin{ Pawn->GetActorLocation() };
+	const float MinDistanceSquared{ FMath::Square(MinDistance) };
+
+	// Cached points first, querying the navmesh only while the region is still being built
+	FNavLocation PatrolPoint;
+	UPatrolRouteSubsystem* PatrolRoutes = bUsePatrolRouteCache ? UPatrolRouteSubsystem::Get(Pawn) : nullptr;
+	bool bSettled{ PatrolRoutes && PatrolRoutes->FindPatrolPoint(Origin, Radius, MinDistance, Memory->bHasLastPatrolPoint ? &Memory->LastPatrolPoint : nullptr, PatrolPoint.Location) };
+	bool bFound{ bSettled };
+	for (int32 Attempt = 0; !bSettled && Attempt < MaxAttempts; ++Attempt)
+	{
+		if (!NavSys->GetRandomPointInNavigableRadius(Origin, Radius, PatrolPoint)) continue;
+
+		bFound = true;
+		const bool bFarFromPawn{ FVector::DistSquared(PatrolPoint.Location, Origin) >= MinDistanceSquared };
+		const bool bFarFromLast{ !Memory->bHasLastPatrolPoint || FVector::DistSquared(PatrolPoint.Location, Memory->LastPatrolPoint) >= MinDistanceSquared };
+		bSettled = bFarFromPawn && bFarFromLast;
+	}
+	if (!bFound) return EBTNodeResult::Failed;
+
+	Memory->LastPatrolPoint = PatrolPoint.Location;
+	Memory->bHasLastPatrolPoint = true;
+
+	if (PatrolPointKey.IsSet())
+	{
+		OwnerComp.GetBlackboardComponent()->SetValue<UBlackboardKeyType_Vector>(PatrolPointKey.GetSelectedKeyID(), PatrolPoint.Location);
+	}
+
+	if (bMoveToPatrolPoint)
+	{
+		AIController->MoveToLocation(PatrolPoint.Location, AcceptanceRadius);
+	}
+	return EBTNodeResult::Succeeded;
+}
+
+void UBTTask_GenPatrolPoint::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+	{
+		PatrolPointKey.ResolveSelectedKey(*BlackboardAsset);
+	}
+}
+
+void UBTTask_GenPatrolPoint::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	FBTGenPatrolPointMemory* Memory = reinterpret_cast<FBTGenPatrolPointMemory*>(NodeMemory);
+	Memory->LastPatrolPoint = FVector::ZeroVector;
+	Memory->bHasLastPatrolPoint = false;
+}
+
+uint16 UBTTask_GenPatrolPoint::GetInstanceMemorySize() const
+{
+	return sizeof(FBTGenPatrolPointMemory);
+}
+
+FString UBTTask_GenPatrolPoint::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("Random point within %.0f, at least %.0f away%s"),
+		Radius,
+		MinDistance,
+		bMoveToPatrolPoint ? TEXT(", moves there") : TEXT(""));
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_GenPatrolPoint.generated.h"
+
+/** Per agent state of the patrol point task */
+struct FBTGenPatrolPointMemory
+{
+	FVector LastPatrolPoint;
+	bool bHasLastPatrolPoint;
+};
+
+/**
+ * Native BTT_GenPatrolPoint: picks a random navigable point around the pawn, at least MinDistance
+ * from the pawn and from its previous patrol point, and moves there.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UBTTask_GenPatrolPoint : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+
+	UBTTask_GenPatrolPoint();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual FString GetStaticDescription() const override;
+
+private:
+
+	UPROPERTY(EditAnywhere, Category = "Patrol", meta = (ClampMin = "0"))
+	float Radius = 1500.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol", meta = (ClampMin = "0"))
+	float MinDistance = 300.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol", meta = (ClampMin = "0"))
+	float AcceptanceRadius = 50.f;
+
+	/** Random points tried before settling for the last one */
+	UPROPERTY(EditAnywhere, Category = "Patrol", meta = (ClampMin = "1"))
+	int32 MaxAttempts = 4;
+
+	/** Optional vector key the patrol point is written to */
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	FBlackboardKeySelector PatrolPointKey;
+
+	/** Take the point from the patrol route subsystem's cache when the pawn's region is built */
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	bool bUsePatrolRouteCache = true;
+
+	/** Only pick the point, for trees that move with their own MoveTo node */
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	bool bMoveToPatrolPoint = true;
+};
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_EnemyAttack.h"
+#include "BTTask_GenPatrolPoint.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "EnemyPoolSubsystem.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/Composites/BTComposite_Sequence.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UnrealType.h"
+
+/**
+ * Benchmark: N enemies run a patrol and attack sequence built from the Blueprint tasks, then the same sequence
+ * built from the native tasks, for the same number of frames each. Reports the average frame time of both.
+ */
+namespace BTTasksBenchmark
+{
+	static const TCHAR* EnemyClassPath{ TEXT("/Game/_Game/Enemies/Grux/BP_EnemyGrux.BP_EnemyGrux_C") };
+	static const TCHAR* AttackTaskPath{ TEXT("/Game/_Game/EnemyController/BTT_Attack.BTT_Attack_C") };
+	static const TCHAR* GenPatrolPointTaskPath{ TEXT("/Game/_Game/EnemyController/BTT_GenPatrolPoint.BTT_GenPatrolPoint_C") };
+
+	/** Enemies spawn this far from the player, so they patrol instead of chasing */
+	static constexpr float MinPlayerDistance{ 3000.f };
+	static constexpr float SpawnRadius{ 2000.f };
+
+	/** Frames left out of each variant while the trees start */
+	static constexpr int32 WarmupFrames{ 30 };
+
+	struct FBTTasksRun
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<TWeakObjectPtr<AEnemy>> Enemies;
+		TStrongObjectPtr<UBehaviorTree> Trees[2];
+		double FrameTimes[2] = { 0.0, 0.0 };
+		int32 Variant = 0;
+		int32 Frame = 0;
+		int32 NumFrames = 0;
+		FDelegateHandle TickerHandle;
+	};
+
+	static FBTTasksRun Run;
+
+	/**
+	 * The Blueprint patrol task moves to its point itself and writes no blackboard key, so the native one is left
+	 * without PatrolPointKey too, moves, and skips the patrol route cache the Blueprint task doesn't have.
+	 * Its distances are copied from the Blueprint task's defaults, so both variants do the same work.
+	 */
+	static void MatchBlueprintPatrolTask(UBTTask_GenPatrolPoint* NativeTask, const UClass* BlueprintClass)
+	{
+		const UObject* BlueprintDefaults = BlueprintClass->GetDefaultObject();
+		for (const TCHAR* PropertyName : { TEXT("Radius"), TEXT("MinDistance"), TEXT("AcceptanceRadius") })
+		{
+			const FFloatProperty* BlueprintProperty = FindFProperty<FFloatProperty>(BlueprintClass, PropertyName);
+			const FFloatProperty* NativeProperty = FindFProperty<FFloatProperty>(UBTTask_GenPatrolPoint::StaticClass(), PropertyName);
+			if (BlueprintProperty && NativeProperty)
+			{
+				NativeProperty->SetPropertyValue_InContainer(NativeTask, BlueprintProperty->GetPropertyValue_InContainer(BlueprintDefaults));
+			}
+		}
+
+		// Private to the task, set through reflection like the editor would
+		if (const FBoolProperty* MoveProperty = FindFProperty<FBoolProperty>(UBTTask_GenPatrolPoint::StaticClass(), TEXT("bMoveToPatrolPoint")))
+		{
+			MoveProperty->SetPropertyValue_InContainer(NativeTask, true);
+		}
+		if (const FBoolProperty* CacheProperty = FindFProperty<FBoolProperty>(UBTTask_GenPatrolPoint::StaticClass(), TEXT("bUsePatrolRouteCache")))
+		{
+			CacheProperty->SetPropertyValue_InContainer(NativeTask, false);
+		}
+	}
+
+	/** Root sequence of GenPatrolPoint then Attack, on the blackboard of the enemy's own tree */
+	static UBehaviorTree* BuildTree(UBlackboardData* BlackboardAsset, TSubclassOf<UBTTaskNode> GenPatrolPointClass, TSubclassOf<UBTTaskNode> AttackClass, const UClass* BlueprintGenPatrolPointClass)
+	{
+		UBehaviorTree* Tree = NewObject<UBehaviorTree>(GetTransientPackage());
+		Tree->BlackboardAsset = BlackboardAsset;
+
+		UBTComposite_Sequence* Sequence = NewObject<UBTComposite_Sequence>(Tree);
+		for (TSubclassOf<UBTTaskNode> TaskClass : { GenPatrolPointClass, AttackClass })
+		{
+			FBTCompositeChild& Child = Sequence->Children.AddDefaulted_GetRef();
+			Child.ChildTask = NewObject<UBTTaskNode>(Tree, TaskClass);
+
+			if (UBTTask_GenPatrolPoint* NativePatrolTask = Cast<UBTTask_GenPatrolPoint>(Child.ChildTask))
+			{
+				MatchBlueprintPatrolTask(NativePatrolTask, BlueprintGenPatrolPointClass);
+			}
+		}
+		Tree->RootNode = Sequence;
+		return Tree;
+	}
+
+	static void RunTree(UBehaviorTree* Tree)
+	{
+		for (const TWeakObjectPtr<AEnemy>& Enemy : Run.Enemies)
+		{
+			if (AEnemyController* EnemyController = Enemy.IsValid() ? Enemy->GetEnemyController() : nullptr)
+			{
+				EnemyController->RunBehaviorTree(Tree);
+			}
+		}
+	}
+
+	static void Finish()
+	{
+		UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(Run.World.Get());
+		for (const TWeakObjectPtr<AEnemy>& Enemy : Run.Enemies)
+		{
+			if (!Enemy.IsValid()) continue;
+			if (!EnemyPool || !EnemyPool->Release(Enemy.Get()))
+			{
+				Enemy->Destroy();
+			}
+		}
+
+		const double BlueprintTime{ Run.FrameTimes[0] / Run.NumFrames * 1000.0 };
+		const double NativeTime{ Run.FrameTimes[1] / Run.NumFrames * 1000.0 };
+		UE_LOG(LogTemp, Display, TEXT("BTTasks: %d enemies over %d frames, Blueprint tasks %.2f ms/frame, native tasks %.2f ms/frame (%+.2f ms)"),
+			Run.Enemies.Num(),
+			Run.NumFrames,
+			BlueprintTime,
+			NativeTime,
+			NativeTime - BlueprintTime);
+
+		Run = FBTTasksRun();
+	}
+
+	static bool Tick(float DeltaTime)
+	{
+		if (!Run.World.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("BTTasks: world went away, aborted"));
+			Run = FBTTasksRun();
+			return false;
+		}
+
+		if (Run.Frame >= WarmupFrames)
+		{
+			Run.FrameTimes[Run.Variant] += DeltaTime;
+		}
+
+		if (++Run.Frame < WarmupFrames + Run.NumFrames) return true;
+
+		if (++Run.Variant < UE_ARRAY_COUNT(Run.Trees))
+		{
+			Run.Frame = 0;
+			RunTree(Run.Trees[Run.Variant].Get());
+			return true;
+		}
+
+		Finish();
+		return false;
+	}
+
+	static void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World) return;
+		if (Run.TickerHandle.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("BTTasks: already running"));
+			return;
+		}
+
+		const int32 NumEnemies{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 500 };
+		const int32 NumFrames{ Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 300 };
+		UClass* EnemyClass = LoadClass<AEnemy>(nullptr, EnemyClassPath);
+		UClass* AttackClass = LoadClass<UBTTaskNode>(nullptr, AttackTaskPath);
+		UClass* GenPatrolPointClass = LoadClass<UBTTaskNode>(nullptr, GenPatrolPointTaskPath);
+		UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(World);
+		if (!EnemyClass || !AttackClass || !GenPatrolPointClass || !EnemyPool || NumEnemies <= 0 || NumFrames <= 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("BTTasks: usage us.Bench.BTTasks [Count] [Frames], needs the Grux enemy and its Blueprint tasks"));
+			return;
+		}
+
+		const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+		const FVector PlayerLocation{ Player ? Player->GetActorLocation() : FVector::ZeroVector };
+		const FVector Center{ PlayerLocation + FVector(MinPlayerDistance + SpawnRadius, 0.f, 0.f) };
+
+		for (int32 Index = 0; Index < NumEnemies; ++Index)
+		{
+			const FVector Location{ Center + FVector(FMath::RandPointInCircle(SpawnRadius), 0.f) };
+			if (AEnemy* Enemy = EnemyPool->Acquire(EnemyClass, FTransform(Location)))
+			{
+				Run.Enemies.Add(Enemy);
+			}
+		}
+
+		const AEnemy* FirstEnemy = Run.Enemies.Num() > 0 ? Run.Enemies[0].Get() : nullptr;
+		UBlackboardData* BlackboardAsset = FirstEnemy && FirstEnemy->GetBehaviorTree() ? FirstEnemy->GetBehaviorTree()->BlackboardAsset : nullptr;
+		Run.Trees[0].Reset(BuildTree(BlackboardAsset, GenPatrolPointClass, AttackClass, GenPatrolPointClass));
+		Run.Trees[1].Reset(BuildTree(BlackboardAsset, UBTTask_GenPatrolPoint::StaticClass(), UBTTask_EnemyAttack::StaticClass(), GenPatrolPointClass));
+
+		Run.World = World;
+		Run.NumFrames = NumFrames;
+		RunTree(Run.Trees[0].Get());
+		Run.TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BTTasksBenchmarkCommand(
+	TEXT("us.Bench.BTTasks"),
+	TEXT("Runs a patrol and attack tree on N enemies (default 500) for F frames (default 300), with the Blueprint tasks then the native ones"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BTTasksBenchmark::Start)
+);
@@ -0,0 +1,315 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BlastDamageSubsystem.h"
+#include "Curves/CurveFloat.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Apply Blast"), STAT_ApplyBlast, STATGROUP_UltimateShooter);
+DECLARE_CYCLE_STAT(TEXT("Resolve Blast"), STAT_ResolveBlast, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blast Victims"), STAT_BlastVictims, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blast Victims Occluded"), STAT_BlastVictimsOccluded, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<int32> CVarExplosiveOcclusion(
+	TEXT("us.Explosives.Occlusion"),
+	1,
+	TEXT("0: blasts go through walls, 1: batched async occlusion traces applied next frame, 2: synchronous trace per victim"));
+
+float FBlastFalloff::GetMultiplier(float Distance, float Radius) const
+{
+	const float Fraction{ Radius > 0.f ? FMath::Clamp(Distance / Radius, 0.f, 1.f) : 0.f };
+	if (Curve)
+	{
+		return FMath::Max(Curve->GetFloatValue(Fraction), 0.f);
+	}
+
+	if (Fraction <= InnerRadiusFraction) return 1.f;
+
+	const float Outer{ (Fraction - InnerRadiusFraction) / FMath::Max(1.f - InnerRadiusFraction, KINDA_SMALL_NUMBER) };
+	return FMath::Lerp(1.f, MinimumMultiplier, FMath::Pow(Outer, Exponent));
+}
+
+void UBlastDamageSubsystem::ApplyBlast(
+	const FVector& Center,
+	float Radius,
+	float BaseDamage,
+	const FBlastFalloff& Falloff,
+	TArrayView<AActor* const> Victims,
+	AController* InstigatorController,
+	AActor* DamageCauser,
+	const AActor* BlastSource,
+	FSimpleDelegate OnApplied)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ApplyBlast);
+	INC_DWORD_STAT_BY(STAT_BlastVictims, Victims.Num());
+
+	const int32 Occlusion{ CVarExplosiveOcclusion.GetValueOnGameThread() };
+
+	// Only level geometry blocks a blast, characters and explosives don't shield each other
+	const FCollisionObjectQueryParams OccluderParams(ECollisionChannel::ECC_WorldStatic);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BlastOcclusion));
+	QueryParams.AddIgnoredActor(BlastSource);
+
+	FPendingBlast Blast;
+	Blast.InstigatorController = InstigatorController;
+	Blast.DamageCauser = DamageCauser;
+	Blast.OnApplied = MoveTemp(OnApplied);
+	Blast.Victims.Reserve(Victims.Num());
+	for (AActor* Actor : Victims)
+	{
+		if (!Actor) continue;
+
+		FBlastVictim& Victim = Blast.Victims.AddDefaulted_GetRef();
+		Victim.Actor = Actor;
+		Victim.Damage = BaseDamage * Falloff.GetMultiplier(FVector::Dist(Center, Actor->GetActorLocation()), Radius);
+
+		if (Occlusion == 2)
+		{
+			Victim.bOccluded = GetWorld()->LineTraceTestByObjectType(Center, Actor->GetActorLocation(), OccluderParams, QueryParams);
+		}
+	}
+
+	if (Occlusion != 1 || Blast.Victims.Num() == 0)
+	{
+		ApplyDamage(Blast);
+		return;
+	}
+
+	// Every trace of the blast shares one delegate, the victim index rides along as user data
+	const int32 BlastId{ NextBlastId++ };
+	FTraceDelegate TraceDelegate{ FTraceDelegate::CreateUObject(this, &UBlastDamageSubsystem::OnOcclusionTraced, BlastId) };
+	for (int32 VictimIndex = 0; VictimIndex < Blast.Victims.Num(); ++VictimIndex)
+	{
+		GetWorld()->AsyncLineTraceByObjectType(
+			EAsyncTraceType::Test,
+			Center,
+			Blast.Victims[VictimIndex].Actor->GetActorLocation(),
+			OccluderParams,
+			QueryParams,
+			&TraceDelegate,
+			VictimIndex
+		);
+	}
+	Blast.NumTracesLeft = Blast.Victims.Num();
+	PendingBlasts.Add(BlastId, MoveTemp(Blast));
+}
+
+UBlastDamageSubsystem* UBlastDamageSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UBlastDamageSubsystem>() : nullptr;
+}
+
+double UBlastDamageSubsystem::ConsumeResolveSeconds()
+{
+	const double Seconds{ ResolveSeconds };
+	ResolveSeconds = 0.0;
+	return Seconds;
+}
+
+void UBlastDamageSubsystem::OnOcclusionTraced(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum, int32 BlastId)
+{
+	FPendingBlast* Blast = PendingBlasts.Find(BlastId);
+	if (!Blast || !Blast->Victims.IsValidIndex(TraceDatum.UserData)) return;
+
+	Blast->Victims[TraceDatum.UserData].bOccluded = TraceDatum.OutHits.Num() > 0;
+	if (--Blast->NumTracesLeft > 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_ResolveBlast);
+	const double StartTime{ FPlatformTime::Seconds() };
+
+	FPendingBlast ResolvedBlast;
+	PendingBlasts.RemoveAndCopyValue(BlastId, ResolvedBlast);
+	ApplyDamage(ResolvedBlast);
+
+	ResolveSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+void UBlastDamageSubsystem::ApplyDamage(const FPendingBlast& Blast)
+{
+	AActor* DamageCauser = Blast.DamageCauser.Get();
+	AController* InstigatorController = Blast.InstigatorController.Get();
+
+	for (const FBlastVictim& Victim : Blast.Victims)
+	{
+		AActor* Actor = Victim.Actor.Get();
+		if (!Actor || Victim.Damage <= 0.f) continue;
+
+		if (Victim.bOccluded)
+		{
+			INC_DWORD_STAT(STAT_BlastVictimsOccluded);
+			continue;
+		}
+
+		UGameplayStatics::ApplyDamage(
+			Actor,
+			Victim.Damage,
+			InstigatorController,
+			DamageCauser,
+			UDamageType::StaticClass()
+		);
+	}
+
+	Blast.OnApplied.ExecuteIfBound();
+}
+
+/**
+ * Benchmark: blasts against N characters, resolved with synchronous traces per victim and with the batched
+ * async traces. Reports the game thread time per blast of each, the async one summed over the frame the blast
+ * is issued on and the frame its traces come back on.
+ */
+namespace BlastBenchmark
+{
+	static constexpr float BlastRadius{ 1000.f };
+	static constexpr float BlastDistance{ 1500.f };
+
+	struct FBlastRun
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<int32> Counts;
+		int32 CountIndex = 0;
+		int32 NumBlasts = 0;
+		FVector Center = FVector::ZeroVector;
+		TArray<TWeakObjectPtr<AActor>> Victims;
+		double SyncSeconds = 0.0;
+		double IssueSeconds = 0.0;
+		int32 FramesWaited = 0;
+		FDelegateHandle TickerHandle;
+	};
+
+	static FBlastRun Run;
+
+	static void DestroyVictims()
+	{
+		for (const TWeakObjectPtr<AActor>& Victim : Run.Victims)
+		{
+			if (Victim.IsValid()) Victim->Destroy();
+		}
+		Run.Victims.Reset();
+	}
+
+	/** Spawns the victims and resolves the blasts synchronously, then issues the async ones */
+	static void BlastCount(UWorld* World, UBlastDamageSubsystem* BlastDamage)
+	{
+		const int32 NumVictims{ Run.Counts[Run.CountIndex] };
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		for (int32 Index = 0; Index < NumVictims; ++Index)
+		{
+			const FVector Location{ Run.Center + FMath::VRand() * FMath::FRand() * BlastRadius * FVector(1.f, 1.f, 0.1f) };
+			if (ACharacter* Victim = World->SpawnActor<ACharacter>(ACharacter::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams))
+			{
+				Run.Victims.Add(Victim);
+			}
+		}
+
+		TArray<AActor*> Victims;
+		for (const TWeakObjectPtr<AActor>& Victim : Run.Victims)
+		{
+			Victims.Add(Victim.Get());
+		}
+
+		const FBlastFalloff Falloff;
+		const int32 OriginalOcclusion{ CVarExplosiveOcclusion.GetValueOnGameThread() };
+
+		CVarExplosiveOcclusion->Set(2, ECVF_SetByConsole);
+		double StartTime{ FPlatformTime::Seconds() };
+		for (int32 Blast = 0; Blast < Run.NumBlasts; ++Blast)
+		{
+			BlastDamage->ApplyBlast(Run.Center, BlastRadius, 1.f, Falloff, Victims, nullptr, nullptr);
+		}
+		Run.SyncSeconds = FPlatformTime::Seconds() - StartTime;
+
+		CVarExplosiveOcclusion->Set(1, ECVF_SetByConsole);
+		BlastDamage->ConsumeResolveSeconds();
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Blast = 0; Blast < Run.NumBlasts; ++Blast)
+		{
+			BlastDamage->ApplyBlast(Run.Center, BlastRadius, 1.f, Falloff, Victims, nullptr, nullptr);
+		}
+		Run.IssueSeconds = FPlatformTime::Seconds() - StartTime;
+
+		CVarExplosiveOcclusion->Set(OriginalOcclusion, ECVF_SetByConsole);
+		Run.FramesWaited = 0;
+	}
+
+	static bool Tick(float DeltaTime)
+	{
+		UWorld* World = Run.World.Get();
+		UBlastDamageSubsystem* BlastDamage = UBlastDamageSubsystem::Get(World);
+		if (!BlastDamage)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Blast: world went away, aborted"));
+			Run = FBlastRun();
+			return false;
+		}
+
+		// Async traces come back at the start of the next world tick
+		if (BlastDamage->GetNumPendingBlasts() > 0 && ++Run.FramesWaited < 10) return true;
+
+		const double NumBlasts{ static_cast<double>(Run.NumBlasts) };
+		const double AsyncSeconds{ Run.IssueSeconds + BlastDamage->ConsumeResolveSeconds() };
+		UE_LOG(LogTemp, Display, TEXT("Blast: %d victims, sync traces %.3f ms/blast, batched async %.3f ms/blast (%.1fx)"),
+			Run.Victims.Num(),
+			Run.SyncSeconds * 1000.0 / NumBlasts,
+			AsyncSeconds * 1000.0 / NumBlasts,
+			AsyncSeconds > 0.0 ? Run.SyncSeconds / AsyncSeconds : 0.0);
+
+		DestroyVictims();
+		if (++Run.CountIndex < Run.Counts.Num())
+		{
+			BlastCount(World, BlastDamage);
+			return true;
+		}
+
+		Run = FBlastRun();
+		return false;
+	}
+
+	static void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		UBlastDamageSubsystem* BlastDamage = UBlastDamageSubsystem::Get(World);
+		if (!BlastDamage) return;
+		if (Run.TickerHandle.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Blast: already running"));
+			return;
+		}
+
+		TArray<FString> CountArgs;
+		(Args.Num() > 0 ? Args[0] : FString(TEXT("1,10,50,200"))).ParseIntoArray(CountArgs, TEXT(","));
+		for (const FString& CountArg : CountArgs)
+		{
+			const int32 Count{ FCString::Atoi(*CountArg) };
+			if (Count > 0) Run.Counts.Add(Count);
+		}
+		Run.NumBlasts = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20;
+		if (Run.Counts.Num() == 0 || Run.NumBlasts <= 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Blast: usage us.Bench.Blast [Count,Count,...] [Blasts]"));
+			Run = FBlastRun();
+			return;
+		}
+
+		// In front of the player, so the traces run against the level around them
+		const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+		Run.Center = Player ? Player->GetActorLocation() + Player->GetActorForwardVector() * BlastDistance : FVector::ZeroVector;
+		Run.World = World;
+
+		BlastCount(World, BlastDamage);
+		Run.TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BlastBenchmarkCommand(
+	TEXT("us.Bench.Blast"),
+	TEXT("Times blasts (default 20) against each victim count (default 1,10,50,200) with synchronous and batched async occlusion traces"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BlastBenchmark::Start)
+);
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "BlastDamageSubsystem.generated.h"
+
+class UCurveFloat;
+
+/** How blast damage falls off from the center to the edge of the blast */
+USTRUCT(BlueprintType)
+struct FBlastFalloff
+{
+	GENERATED_BODY()
+
+	/** Damage multiplier over the distance from the center divided by the radius. Overrides the settings below when set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Falloff")
+	UCurveFloat* Curve = nullptr;
+
+	/** Fraction of the radius that takes full damage */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Falloff", meta = (ClampMin = "0", ClampMax = "1"))
+	float InnerRadiusFraction = 0.25f;
+
+	/** Multiplier at the edge of the blast */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Falloff", meta = (ClampMin = "0", ClampMax = "1"))
+	float MinimumMultiplier = 0.25f;
+
+	/** 1 falls off linearly, higher keeps more damage further out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Falloff", meta = (ClampMin = "0.1"))
+	float Exponent = 1.f;
+
+	float GetMultiplier(float Distance, float Radius) const;
+};
+
+/** A victim of a blast waiting for its occlusion trace */
+struct FBlastVictim
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Damage after falloff */
+	float Damage = 0.f;
+
+	bool bOccluded = false;
+};
+
+/** A blast whose occlusion traces are in flight */
+struct FPendingBlast
+{
+	TArray<FBlastVictim> Victims;
+	TWeakObjectPtr<AController> InstigatorController;
+	TWeakObjectPtr<AActor> DamageCauser;
+	FSimpleDelegate OnApplied;
+	int32 NumTracesLeft = 0;
+};
+
+/**
+ * Radial damage for explosives, with falloff and occlusion by level geometry.
+ * Each blast issues one async trace per victim, all in the same frame's async trace batch, and applies its damage
+ * once every trace is back on the next frame, instead of tracing to each victim synchronously.
+ * us.Explosives.Occlusion 0 skips the traces, 2 traces synchronously for comparison.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UBlastDamageSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Damages each victim once, scaled by its distance from the center, unless level geometry other than BlastSource blocks the blast.
+	 * OnApplied runs once the damage is applied, which is the next frame with async occlusion traces.
+	 */
+	void ApplyBlast(
+		const FVector& Center,
+		float Radius,
+		float BaseDamage,
+		const FBlastFalloff& Falloff,
+		TArrayView<AActor* const> Victims,
+		AController* InstigatorController,
+		AActor* DamageCauser,
+		const AActor* BlastSource = nullptr,
+		FSimpleDelegate OnApplied = FSimpleDelegate());
+
+	static UBlastDamageSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Game thread time spent applying traced blasts since the last call, for benchmarks */
+	double ConsumeResolveSeconds();
+
+	FORCEINLINE int32 GetNumPendingBlasts() const { return PendingBlasts.Num(); }
+
+private:
+
+	/** Victims are matched to their trace through the trace's user data */
+	void OnOcclusionTraced(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum, int32 BlastId);
+
+	static void ApplyDamage(const FPendingBlast& Blast);
+
+	TMap<int32, FPendingBlast> PendingBlasts;
+
+	int32 NextBlastId = 0;
+
+	double ResolveSeconds = 0.0;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class ECombatAudioCategory : uint8
+{
+	ECAC_Impact UMETA(DisplayName = "Impact"),
+	ECAC_Melee UMETA(DisplayName = "Melee"),
+	ECAC_Death UMETA(DisplayName = "Death"),
+	ECAC_Vocal UMETA(DisplayName = "Vocal"),
+	ECAC_Cue UMETA(DisplayName = "Cue"),
+	ECAC_Pickup UMETA(DisplayName = "Pickup"),
+
+	ECAC_MAX UMETA(DisplayName = "DefaultMAX")
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatAudioSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Voices Started"), STAT_CombatVoicesStarted, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Voices Coalesced"), STAT_CombatVoicesCoalesced, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Voices Over Budget"), STAT_CombatVoicesOverBudget, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Voices Culled"), STAT_CombatVoicesCulled, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<int32> CVarCombatAudioRouter(
+	TEXT("us.Audio.Router"),
+	1,
+	TEXT("0 plays every combat sound directly, 1 coalesces, budgets and culls them"));
+
+static TAutoConsoleVariable<float> CVarCombatAudioCoalesceTime(
+	TEXT("us.Audio.CoalesceTime"),
+	0.08f,
+	TEXT("Seconds within which an identical cue close by is dropped"));
+
+static TAutoConsoleVariable<float> CVarCombatAudioCoalesceRadius(
+	TEXT("us.Audio.CoalesceRadius"),
+	400.f,
+	TEXT("Distance within which an identical recent cue is dropped"));
+
+namespace CombatAudio
+{
+	/** Max voices of each category playing at once */
+	static const int32 CategoryBudgets[(int32)ECombatAudioCategory::ECAC_MAX] =
+	{
+		8,	// Impact
+		4,	// Melee
+		4,	// Death
+		3,	// Vocal
+		3,	// Cue
+		2	// Pickup
+	};
+
+	/** Looping and unknown length sounds are counted against the budget for this long */
+	static const float MaxVoiceDuration = 3.f;
+}
+
+bool UCombatAudioSubsystem::PlaySoundAtLocation(const UObject* WorldContextObject, USoundBase* Sound, const FVector& Location, ECombatAudioCategory Category)
+{
+	if (UCombatAudioSubsystem* CombatAudio = Get(WorldContextObject))
+	{
+		return CombatAudio->Play(Sound, Location, Category, false);
+	}
+	UGameplayStatics::PlaySoundAtLocation(WorldContextObject, Sound, Location);
+	return Sound != nullptr;
+}
+
+bool UCombatAudioSubsystem::PlaySound2D(const UObject* WorldContextObject, USoundBase* Sound, ECombatAudioCategory Category)
+{
+	if (UCombatAudioSubsystem* CombatAudio = Get(WorldContextObject))
+	{
+		return CombatAudio->Play(Sound, FVector::ZeroVector, Category, true);
+	}
+	UGameplayStatics::PlaySound2D(WorldContextObject, Sound);
+	return Sound != nullptr;
+}
+
+bool UCombatAudioSubsystem::Play(USoundBase* Sound, const FVector& Location, ECombatAudioCategory Category, bool bIs2D)
+{
+	if (!Sound || Category == ECombatAudioCategory::ECAC_MAX) return false;
+
+	const double Now{ GetWorld()->GetRealTimeSeconds() };
+
+	if (CVarCombatAudioRouter.GetValueOnGameThread() != 0)
+	{
+		if (!bIs2D && IsOutOfRange(Sound, Location))
+		{
+			++VoicesCulled;
+			INC_DWORD_STAT(STAT_CombatVoicesCulled);
+			return false;
+		}
+
+		if (IsCoalesced(Sound, Location, Now, bIs2D))
+		{
+			++VoicesCoalesced;
+			INC_DWORD_STAT(STAT_CombatVoicesCoalesced);
+			return false;
+		}
+
+		if (IsOverBudget(Category, Now))
+		{
+			++VoicesOverBudget;
+			INC_DWORD_STAT(STAT_CombatVoicesOverBudget);
+			return false;
+		}
+	}
+
+	if (bIs2D)
+	{
+		UGameplayStatics::PlaySound2D(GetWorld(), Sound);
+	}
+	else
+	{
+		UGameplayStatics::PlaySoundAtLocation(GetWorld(), Sound, Location);
+	}
+
+	const float Duration{ Sound->GetDuration() };
+	const float BudgetDuration{ (Duration > 0.f && Duration < CombatAudio::MaxVoiceDuration) ? Duration : CombatAudio::MaxVoiceDuration };
+	CategoryVoiceEndTimes[(int32)Category].Add(Now + BudgetDuration);
+	RecentCues.Add({ Sound, Location, Now });
+
+	++VoicesStarted;
+	INC_DWORD_STAT(STAT_CombatVoicesStarted);
+	return true;
+}
+
+UCombatAudioSubsystem* UCombatAudioSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UCombatAudioSubsystem>() : nullptr;
+}
+
+bool UCombatAudioSubsystem::IsOutOfRange(const USoundBase* Sound, const FVector& Location) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController) return false;
+
+	FVector ListenerLocation;
+	FVector ListenerFront;
+	FVector ListenerRight;
+	PlayerController->GetAudioListenerPosition(ListenerLocation, ListenerFront, ListenerRight);
+
+	// Sounds without attenuation report WORLD_MAX and are never culled
+	const float MaxDistance{ Sound->GetMaxDistance() };
+	return FVector::DistSquared(ListenerLocation, Location) > FMath::Square(MaxDistance);
+}
+
+bool UCombatAudioSubsystem::IsCoalesced(const USoundBase* Sound, const FVector& Location, double Now, bool bIs2D)
+{
+	const float CoalesceTime{ CVarCombatAudioCoalesceTime.GetValueOnGameThread() };
+	const float CoalesceRadiusSquared{ FMath::Square(CVarCombatAudioCoalesceRadius.GetValueOnGameThread()) };
+
+	RecentCues.RemoveAllSwap([Now, CoalesceTime](const FRecentCue& Cue) { return Now - Cue.StartTime > CoalesceTime; }, false);
+
+	for (const FRecentCue& Cue : RecentCues)
+	{
+		if (Cue.Sound.Get() == Sound && (bIs2D || FVector::DistSquared(Cue.Location, Location) <= CoalesceRadiusSquared))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UCombatAudioSubsystem::IsOverBudget(ECombatAudioCategory Category, double Now)
+{
+	TArray<double>& VoiceEndTimes = CategoryVoiceEndTimes[(int32)Category];
+	VoiceEndTimes.RemoveAllSwap([Now](double EndTime) { return EndTime <= Now; }, false);
+
+	return VoiceEndTimes.Num() >= CombatAudio::CategoryBudgets[(int32)Category];
+}
+
+static FAutoConsoleCommandWithWorld CombatAudioStatsCommand(
+	TEXT("us.Audio.Stats"),
+	TEXT("Logs how many combat voices the router started and saved in this world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCombatAudioSubsystem* CombatAudio = World ? World->GetSubsystem<UCombatAudioSubsystem>() : nullptr)
+		{
+			UE_LOG(LogTemp, Display, TEXT("CombatAudio: %d started, %d saved (%d coalesced, %d over budget, %d culled)"),
+				CombatAudio->GetVoicesStarted(),
+				CombatAudio->GetVoicesSaved(),
+				CombatAudio->GetVoicesCoalesced(),
+				CombatAudio->GetVoicesOverBudget(),
+				CombatAudio->GetVoicesCulled());
+		}
+	})
+);
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatAudioCategory.h"
+#include "CombatAudioSubsystem.generated.h"
+
+class USoundBase;
+
+/**
+ * Routes combat sounds so a burst into a crowd doesn't start dozens of voices in one frame.
+ * Before any audio component is created, a sound is dropped when it is out of hearing range,
+ * when the same cue just played close by, or when its category is out of voices.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UCombatAudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Plays a 3D combat sound through the router, returns true if a voice was started */
+	static bool PlaySoundAtLocation(const UObject* WorldContextObject, USoundBase* Sound, const FVector& Location, ECombatAudioCategory Category);
+
+	/** Plays a 2D combat sound through the router, returns true if a voice was started */
+	static bool PlaySound2D(const UObject* WorldContextObject, USoundBase* Sound, ECombatAudioCategory Category);
+
+	bool Play(USoundBase* Sound, const FVector& Location, ECombatAudioCategory Category, bool bIs2D);
+
+	static UCombatAudioSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Voices not started since the world began */
+	FORCEINLINE int32 GetVoicesCoalesced() const { return VoicesCoalesced; }
+	FORCEINLINE int32 GetVoicesOverBudget() const { return VoicesOverBudget; }
+	FORCEINLINE int32 GetVoicesCulled() const { return VoicesCulled; }
+	FORCEINLINE int32 GetVoicesStarted() const { return VoicesStarted; }
+
+	UFUNCTION(BlueprintPure, Category = "Combat Audio")
+	int32 GetVoicesSaved() const { return VoicesCoalesced + VoicesOverBudget + VoicesCulled; }
+
+private:
+
+	bool IsOutOfRange(const USoundBase* Sound, const FVector& Location) const;
+
+	bool IsCoalesced(const USoundBase* Sound, const FVector& Location, double Now, bool bIs2D);
+
+	bool IsOverBudget(ECombatAudioCategory Category, double Now);
+
+	/** A cue started recently, identical cues close to it are dropped */
+	struct FRecentCue
+	{
+		TWeakObjectPtr<const USoundBase> Sound;
+		FVector Location;
+		double StartTime;
+	};
+
+	TArray<FRecentCue> RecentCues;
+
+	/** Estimated end time of the voices of each category */
+	TArray<double> CategoryVoiceEndTimes[(int32)ECombatAudioCategory::ECAC_MAX];
+
+	int32 VoicesStarted = 0;
+	int32 VoicesCoalesced = 0;
+	int32 VoicesOverBudget = 0;
+	int32 VoicesCulled = 0;
+};
@@ -6,6 +6,7 @@
 #include "Components/CapsuleComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "ShooterCharacter.h"
+#include "ParticlePoolSubsystem.h"
 
 // Sets default values
 AControlPoint::AControlPoint() :
@@ -140,13 +141,9 @@ void AControlPoint::PlayApplyBonusEffect()
 {
 	if (ApplyBonusParticles)
 	{
-		UGameplayStatics::SpawnEmitterAttached(
+		UParticlePoolSubsystem::SpawnEmitterAttached(
 			ApplyBonusParticles,
-			Cast<USceneComponent>(ShooterCharacter->GetCapsuleComponent()),
-			NAME_None,
-			((FVector)(ForceInit)),
-			FRotator::ZeroRotator,
-			EAttachLocation::SnapToTargetIncludingScale
+			Cast<USceneComponent>(ShooterCharacter->GetCapsuleComponent())
 		);
 	}
 }
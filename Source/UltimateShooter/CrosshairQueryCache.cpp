@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CrosshairQueryCache.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "UltimateShooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Traces"), STAT_CrosshairTraces, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Traces Saved"), STAT_CrosshairTracesSaved, STATGROUP_UltimateShooter);
+
+bool FCrosshairQueryCache::Query(APlayerController* PlayerController, FHitResult& OutHitResult, FVector& OutTraceEnd)
+{
+	if (!PlayerController || !PlayerController->PlayerCameraManager) return false;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->PlayerCameraManager->GetCameraViewPoint(ViewLocation, ViewRotation);
+
+	if (IsValidFor(GFrameCounter, ViewLocation, ViewRotation))
+	{
+		INC_DWORD_STAT(STAT_CrosshairTracesSaved);
+		OutHitResult = CachedHitResult;
+		OutTraceEnd = CachedTraceEnd;
+		return true;
+	}
+
+	// The centre of the screen deprojects to the camera's forward vector
+	const FVector Start{ ViewLocation };
+	const FVector End{ ViewLocation + ViewRotation.Vector() * TraceLength };
+
+	CachedHitResult = FHitResult();
+	PlayerController->GetWorld()->LineTraceSingleByChannel(
+		CachedHitResult,
+		Start,
+		End,
+		ECollisionChannel::ECC_Visibility
+	);
+	INC_DWORD_STAT(STAT_CrosshairTraces);
+
+	bValid = true;
+	CachedFrameNumber = GFrameCounter;
+	CachedViewLocation = ViewLocation;
+	CachedViewRotation = ViewRotation;
+	CachedTraceEnd = End;
+
+	OutHitResult = CachedHitResult;
+	OutTraceEnd = CachedTraceEnd;
+	return true;
+}
+
+bool FCrosshairQueryCache::GetCrosshairRay(APlayerController* PlayerController, FVector& OutStart, FVector& OutEnd)
+{
+	if (!PlayerController || !PlayerController->PlayerCameraManager) return false;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->PlayerCameraManager->GetCameraViewPoint(ViewLocation, ViewRotation);
+
+	OutStart = ViewLocation;
+	OutEnd = ViewLocation + ViewRotation.Vector() * TraceLength;
+	return true;
+}
+
+bool FCrosshairQueryCache::IsValidFor(uint64 FrameNumber, const FVector& ViewLocation, const FRotator& ViewRotation) const
+{
+	return bValid &&
+		CachedFrameNumber == FrameNumber &&
+		CachedViewLocation.Equals(ViewLocation) &&
+		CachedViewRotation.Equals(ViewRotation);
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Caches the crosshair ray and the long visibility trace under it for one frame.
+ * Keyed on the frame number and the camera transform, so TraceForItems, FireWeapon
+ * and GetBeamEndLocation share a single trace no matter how many times they ask.
+ */
+struct FCrosshairQueryCache
+{
+public:
+
+	/** Length of the crosshair trace from the camera */
+	static constexpr float TraceLength = 50'000.f;
+
+	/**
+	* Returns the crosshair trace for this frame, running it only if the cache is stale.
+	* @param PlayerController Controller whose camera manager provides the view
+	* @param OutHitResult Result of the visibility trace under the crosshairs
+	* @param OutTraceEnd End of the trace, used when nothing was hit
+	* @return false if there is no camera to trace from
+	*/
+	bool Query(APlayerController* PlayerController, FHitResult& OutHitResult, FVector& OutTraceEnd);
+
+	/** Gets the crosshair ray straight from the camera manager, without tracing */
+	static bool GetCrosshairRay(APlayerController* PlayerController, FVector& OutStart, FVector& OutEnd);
+
+	/** Forces the next query to trace again */
+	void Invalidate() { bValid = false; }
+
+private:
+
+	bool IsValidFor(uint64 FrameNumber, const FVector& ViewLocation, const FRotator& ViewRotation) const;
+
+	bool bValid = false;
+
+	uint64 CachedFrameNumber = 0;
+
+	FVector CachedViewLocation = FVector::ZeroVector;
+
+	FRotator CachedViewRotation = FRotator::ZeroRotator;
+
+	FVector CachedTraceEnd = FVector::ZeroVector;
+
+	FHitResult CachedHitResult;
+};
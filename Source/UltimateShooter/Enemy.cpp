@@ -12,7 +12,6 @@
 #include "Components/SphereComponent.h"
 #include "ShooterCharacter.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/BoxComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "Explosive.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -21,16 +20,27 @@
 #include "ShooterGameState.h"
 #include "Announcer.h"
 #include "Misc/DateTime.h"
+#include "ParticlePoolSubsystem.h"
+#include "CombatAudioSubsystem.h"
+#include "HitNumberSubsystem.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "EnemySignificanceSubsystem.h"
+#include "EnemySquad.h"
+#include "EnemySquadSubsystem.h"
+#include "EnemyPoolSubsystem.h"
+#include "PatrolRouteSubsystem.h"
 
 // Sets default values
 AEnemy::AEnemy() :
 	Health(100.f),
 	MaxHealth(100.f),
+	HordeProxyMesh(nullptr),
 	HealthBarDisplayTime(4.f),
 	bCanHitReact(true),
 	HitReactTimeMin(.5f),
 	HitReactTimeMax(3.5f),
 	HitNumberDestroyTime(1.5f),
+	bUsePatrolRoute(false),
 	bStunned(false),
 	StunChance(0.5f),
 	AttackLFast(TEXT("AttackLFast")),
@@ -40,9 +50,17 @@ AEnemy::AEnemy() :
 	BaseDamage(20.f),
 	LeftWeaponSocket(TEXT("FX_Trail_L_02")),
 	RightWeaponSocket(TEXT("FX_Trail_R_02")),
+	LeftWeaponBaseSocket(TEXT("LeftWeaponBone")),
+	RightWeaponBaseSocket(TEXT("RightWeaponBone")),
+	LeftWeaponSweepRadius(32.f),
+	RightWeaponSweepRadius(32.f),
+	NumMeleeHits(0),
+	bImplementsReceiveTick(false),
 	bCanAttack(true),
 	AttackWaitTime(1.f),
 	bDying(false),
+	bRegisteredForPerception(false),
+	Significance(EEnemySignificance::EES_Critical),
 	DeathTime(4.f),
 	ExplosiveSlowMotionTime(1.25f),
 	bInExplosiveSlowMotion(false),
@@ -55,10 +73,15 @@ AEnemy::AEnemy() :
 	ScoutMinWalkSpeedBoost(30.f),
 	ScoutMaxWalkSpeedBoost(60.f),
 	ScoutMinRageDamageBonus(5.f),
-	ScoutMaxRageDamageBonus(15.f)
+	ScoutMaxRageDamageBonus(15.f),
+	Squad(nullptr),
+	SquadWalkSpeedBonus(0.f),
+	SquadDamageBonus(0.f)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+	// Hit numbers are moved by the hit number subsystem, only weapon sweeps and Blueprint Event Tick need the actor to tick
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Create Agro Sphere
 	AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
@@ -71,12 +94,6 @@ AEnemy::AEnemy() :
 	// Create Combat Range Sphere
 	CombatRangeSphere = CreateDefaultSubobject<USphereComponent>(TEXT("CombatRangeSphere"));
 	CombatRangeSphere->SetupAttachment(GetRootComponent());
-
-	LeftWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("LeftWeaponBox"));
-	LeftWeaponCollision->SetupAttachment(GetMesh(), FName("LeftWeaponBone"));
-
-	RightWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("RightWeaponBox"));
-	RightWeaponCollision->SetupAttachment(GetMesh(), FName("RightWeaponBone"));
 }
 
 // Called when the game starts or when spawned
@@ -84,30 +101,12 @@ void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();
 
-	AgroSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::AgroSphereOverlap); // Bind the overlap event
-
-	if (bScouting)
-	{
-		ScoutSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::ScoutSphereOverlap); // Bind the scout sphere overlap event
-	}
-
-	CombatRangeSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::CombatSphereOverlap); //Bind the combat sphere begin overlap
-	CombatRangeSphere->OnComponentEndOverlap.AddDynamic(this, &AEnemy::CombatSphereEndOverlap); // Bind the combat sphere end overlap
+	bImplementsReceiveTick = GetClass()->IsFunctionImplementedInScript(FName("ReceiveTick"));
+	UpdateTickEnabled();
 
-	// Bind Functions to Weapon Overlap Events
-	LeftWeaponCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnLeftWeaponOverlap);
-	RightWeaponCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnRightWeaponOverlap);
-
-	// Set Collisions For Weapons
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	LeftWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	LeftWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	LeftWeaponCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
-
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	RightWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	RightWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	RightWeaponCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+	// Resolve hit zones to bone indices once
+	HeadBoneName = FName(*HeadBone);
+	HitZones.Build(GetMesh(), HitZoneTable, HeadBoneName);
 
 	// Enable Collisions for Impact
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
@@ -118,12 +117,86 @@ void AEnemy::BeginPlay()
 	// Get the AI controller
 	EnemyController = Cast<AEnemyController>(GetController());
 
-	// Set Attack Flag
-	if (EnemyController)
+	RegisterWithSubsystems();
+	StartBehaviorTree();
+}
+
+void AEnemy::RegisterWithSubsystems()
+{
+	UEnemyPerceptionSubsystem* Perception = UEnemyPerceptionSubsystem::Get(this);
+	if (Perception && UEnemyPerceptionSubsystem::IsPerceptionEnabled())
+	{
+		// Ranges come from the perception grid, the spheres only hold their radii
+		for (USphereComponent* Sphere : { AgroSphere, ScoutSphere, CombatRangeSphere })
+		{
+			Sphere->SetGenerateOverlapEvents(false);
+			Sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+		Perception->RegisterEnemy(this);
+		bRegisteredForPerception = true;
+	}
+	else
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), true);
+		AgroSphere->OnComponentBeginOverlap.AddUniqueDynamic(this, &AEnemy::AgroSphereOverlap); // Bind the overlap event
+
+		if (bScouting)
+		{
+			ScoutSphere->OnComponentBeginOverlap.AddUniqueDynamic(this, &AEnemy::ScoutSphereOverlap); // Bind the scout sphere overlap event
+		}
+
+		CombatRangeSphere->OnComponentBeginOverlap.AddUniqueDynamic(this, &AEnemy::CombatSphereOverlap); //Bind the combat sphere begin overlap
+		CombatRangeSphere->OnComponentEndOverlap.AddUniqueDynamic(this, &AEnemy::CombatSphereEndOverlap); // Bind the combat sphere end overlap
 	}
 
+	if (UEnemySignificanceSubsystem* EnemySignificance = UEnemySignificanceSubsystem::Get(this))
+	{
+		EnemySignificance->RegisterEnemy(this);
+	}
+
+	if (UEnemySquadSubsystem* EnemySquads = UEnemySquadSubsystem::Get(this))
+	{
+		if (UEnemySquad* NamedSquad = EnemySquads->FindOrCreateSquad(SquadName))
+		{
+			NamedSquad->AddMember(this);
+		}
+	}
+}
+
+void AEnemy::UnregisterFromSubsystems()
+{
+	if (bRegisteredForPerception)
+	{
+		if (UEnemyPerceptionSubsystem* Perception = UEnemyPerceptionSubsystem::Get(this))
+		{
+			Perception->UnregisterEnemy(this);
+		}
+		bRegisteredForPerception = false;
+	}
+	if (UEnemySignificanceSubsystem* EnemySignificance = UEnemySignificanceSubsystem::Get(this))
+	{
+		EnemySignificance->UnregisterEnemy(this);
+	}
+	if (Squad)
+	{
+		Squad->RemoveMember(this);
+	}
+	if (UPatrolRouteSubsystem* PatrolRoutes = bUsePatrolRoute ? UPatrolRouteSubsystem::Get(this) : nullptr)
+	{
+		PatrolRoutes->CancelRoute(this);
+	}
+	AgroSphere->OnComponentBeginOverlap.RemoveAll(this);
+	CombatRangeSphere->OnComponentBeginOverlap.RemoveAll(this);
+	CombatRangeSphere->OnComponentEndOverlap.RemoveAll(this);
+	ScoutSphere->OnComponentBeginOverlap.RemoveAll(this);
+}
+
+void AEnemy::StartBehaviorTree()
+{
+	if (!EnemyController) return;
+
+	// Set Attack Flag
+	EnemyController->GetEnemyBlackboard().SetCanAttack(true);
+
 	// Transform Local Vector: PatrolPoint to World Space Vector
 	const FVector WorldPatrolPoint = UKismetMathLibrary::TransformLocation(
 		GetActorTransform(), 
@@ -136,23 +209,22 @@ void AEnemy::BeginPlay()
 		PatrolPoint2
 	);
 
-	if (EnemyController)
-	{
-		// Set 1st Patrol point Vector value to blackboard
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(
-			TEXT("PatrolPoint"), 
-			WorldPatrolPoint
-		);
+	// Set 1st Patrol point Vector value to blackboard
+	EnemyController->GetEnemyBlackboard().SetPatrolPoint(WorldPatrolPoint);
 
-		// Set 2nd Patrol point Vector value to blackboard
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(
-			TEXT("PatrolPoint2"),
-			WorldPatrolPoint2
-		);
+	// Set 2nd Patrol point Vector value to blackboard
+	EnemyController->GetEnemyBlackboard().SetPatrolPoint2(WorldPatrolPoint2);
 
-		EnemyController->RunBehaviorTree(BehaviorTree);
+	// The placed points hold until the route arrives
+	if (bUsePatrolRoute)
+	{
+		if (UPatrolRouteSubsystem* PatrolRoutes = UPatrolRouteSubsystem::Get(this))
+		{
+			PatrolRoutes->RequestRoute(this);
+		}
 	}
 
+	EnemyController->RunBehaviorTree(BehaviorTree);
 }
 
 void AEnemy::ShowHealthBar_Implementation()
@@ -226,11 +298,8 @@ void AEnemy::Die(bool bForce)
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Ignore);
 
 	//Unbind Overlap Events
-	AgroSphere->OnComponentBeginOverlap.RemoveAll(this);
-	CombatRangeSphere->OnComponentBeginOverlap.RemoveAll(this);
-	ScoutSphere->OnComponentBeginOverlap.RemoveAll(this);
-	LeftWeaponCollision->OnComponentBeginOverlap.RemoveAll(this);
-	RightWeaponCollision->OnComponentBeginOverlap.RemoveAll(this);
+	UnregisterFromSubsystems();
+	StopWeaponSweeps();
 
 	// TODO: IMPROVE THIS: SEE Take Damage
 	//HideHealthBar();
@@ -248,13 +317,13 @@ void AEnemy::Die(bool bForce)
 		
 		if (DeathSound)
 		{
-			UGameplayStatics::PlaySoundAtLocation(GetWorld(), DeathSound, GetActorLocation());
+			UCombatAudioSubsystem::PlaySoundAtLocation(GetWorld(), DeathSound, GetActorLocation(), ECombatAudioCategory::ECAC_Death);
 		}
 	}
 
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("Dead"), true);
+		EnemyController->GetEnemyBlackboard().SetDead(true);
 		// Also stop movement after Death
 		EnemyController->StopMovement();
 	}
@@ -283,49 +352,30 @@ void AEnemy::ResetHitReactTimer()
 	bCanHitReact = true;
 }
 
-void AEnemy::StoreHitNumber(UUserWidget* HitNumber, FVector Location)
-{
-	HitNumbers.Add(HitNumber, Location);
-
-	// Create a local timer and bind it to a function(DestroyHitNumber) which has input params
-	// We dont use a member variable for this timer because for each hit we need a seperate timer!
-	FTimerHandle HitNumberTimer;
-	FTimerDelegate HitNumberDelegate;
-
-	HitNumberDelegate.BindUFunction(this, FName("DestroyHitNumber"), HitNumber);
-	GetWorld()->GetTimerManager().SetTimer(
-		HitNumberTimer, 
-		HitNumberDelegate, 
-		HitNumberDestroyTime, 
-		false
-	);
-}
-
-void AEnemy::DestroyHitNumber(UUserWidget* HitNumber)
+UUserWidget* AEnemy::AcquireHitNumber()
 {
-	HitNumbers.Remove(HitNumber);
-	HitNumber->RemoveFromParent();
+	UHitNumberSubsystem* HitNumbers = UHitNumberSubsystem::Get(this);
+	return HitNumbers ? HitNumbers->AcquireWidget() : nullptr;
 }
 
-void AEnemy::UpdateHitNumbers()
+void AEnemy::StoreHitNumber(UUserWidget* HitNumber, FVector Location)
 {
-	for (auto& HitPair : HitNumbers) // Range based for loop
+	if (UHitNumberSubsystem* HitNumbers = UHitNumberSubsystem::Get(this))
 	{
-		UUserWidget* HitNumber{ HitPair.Key };
-		const FVector Location{ HitPair.Value };
-		FVector2D ScreenPosition;
-
-		UGameplayStatics::ProjectWorldToScreen(
-			GetWorld()->GetFirstPlayerController(),
-			Location,
-			ScreenPosition
-		);
-
-		HitNumber->SetPositionInViewport(ScreenPosition); // Loop through and set screen pos for each
+		HitNumbers->AddHitNumber(HitNumber, Location, HitNumberDestroyTime);
+	}
+	else if (HitNumber)
+	{
+		HitNumber->RemoveFromParent();
 	}
 }
 
 void AEnemy::AgroSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	OnAgroRangeEntered(OtherActor);
+}
+
+void AEnemy::OnAgroRangeEntered(AActor* OtherActor)
 {
 	if (bDying || !OtherActor) return;
 
@@ -334,10 +384,10 @@ void AEnemy::AgroSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* Othe
 	{
 		if (EnemyController)
 		{
-			if (EnemyController->GetBlackboardComponent())
+			if (EnemyController->GetEnemyBlackboard().IsValid())
 			{
 				// Set the value of the "Target" key
-				EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("TargetActor"), Character);
+				EnemyController->GetEnemyBlackboard().SetTargetActor(Character);
 				GetCharacterMovement()->RotationRate = FRotator(0.f, 120.f, 0.f);
 			}
 		}
@@ -345,6 +395,11 @@ void AEnemy::AgroSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* Othe
 }
 
 void AEnemy::ScoutSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	OnScoutRangeEntered(OtherActor);
+}
+
+void AEnemy::OnScoutRangeEntered(AActor* OtherActor)
 {
 	if (bDying) return;
 	if (!bScouting) return;
@@ -368,41 +423,82 @@ void AEnemy::ScoutSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* Oth
 			);
 		}
 
-		TArray<AActor*> OverlappedAllies;
-		GetOverlappingActors(OverlappedAllies, AEnemy::StaticClass());
+		TArray<AEnemy*> OverlappedAllies;
+		UEnemyPerceptionSubsystem* Perception = UEnemyPerceptionSubsystem::Get(this);
+		if (Perception && bRegisteredForPerception)
+		{
+			Perception->QueryEnemiesInRadius(GetActorLocation(), ScoutSphere->GetScaledSphereRadius(), OverlappedAllies);
+		}
+		else
+		{
+			TArray<AActor*> OverlappedActors;
+			GetOverlappingActors(OverlappedActors, AEnemy::StaticClass());
+			for (auto AllyActor : OverlappedActors)
+			{
+				OverlappedAllies.Add(Cast<AEnemy>(AllyActor));
+			}
+		}
+
+		// The scout leads its squad, or an ad-hoc one of the allies around it
+		if (!Squad)
+		{
+			if (UEnemySquadSubsystem* EnemySquads = UEnemySquadSubsystem::Get(this))
+			{
+				EnemySquads->CreateScoutSquad(this)->AddMember(this);
+			}
+		}
+		if (!Squad) return;
+
+		FSquadBuff ScoutBuff;
+		ScoutBuff.WalkSpeedBonus = FMath::FRandRange(ScoutMinWalkSpeedBoost, ScoutMaxWalkSpeedBoost);
+		if (bRaging)
+		{
+			ScoutBuff.DamageBonus = FMath::FRandRange(ScoutMinRageDamageBonus, ScoutMaxRageDamageBonus);
+		}
 
-		for (auto AllyActor : OverlappedAllies)
+		// Allies without a squad join this one, allies of other squads alert their own
+		TArray<UEnemySquad*, TInlineAllocator<4>> OtherSquads;
+		for (auto Ally : OverlappedAllies)
 		{
-			auto Ally = Cast<AEnemy>(AllyActor);
-			if (Ally && !Ally->bScouting && Ally->bRespondToScouts)
+			if (!Ally || Ally == this || Ally->bDying) continue;
+
+			if (!Ally->Squad)
+			{
+				Squad->AddMember(Ally);
+			}
+			else if (Ally->Squad != Squad)
 			{
-				if (Ally->EnemyController)
-				{
-					// Speed boost all allies!
-					if (bRaging)
-					{
-						Ally->BaseDamage += FMath::FRandRange(ScoutMinRageDamageBonus, ScoutMaxRageDamageBonus);
-					}
-					Ally->GetCharacterMovement()->MaxWalkSpeed += FMath::FRandRange(ScoutMinWalkSpeedBoost, ScoutMaxWalkSpeedBoost);
-					
-					if (Ally->InitiateAmbushSound)
-					{
-						if (!GetWorldTimerManager().IsTimerActive(Ally->InitiateAmbushSoundTimer))
-						{
-							GetWorldTimerManager().SetTimer(
-								Ally->InitiateAmbushSoundTimer,
-								Ally,
-								&ThisClass::PlayInitiateAmbushSound,
-								FMath::RandRange(EnemyDetectedSoundCooldown + 1.0f, Ally->InitiateAmbushSoundCooldown)
-							);
-						}
-					}
-					
-					Ally->EnemyController->GetBlackboardComponent()->SetValueAsObject(FName("TargetActor"), Character);
-					GetCharacterMovement()->RotationRate = FRotator(0.f, 120.f, 0.f);
-				}
+				OtherSquads.AddUnique(Ally->Squad);
 			}
 		}
+
+		Squad->Alert(Character, ScoutBuff);
+		for (UEnemySquad* OtherSquad : OtherSquads)
+		{
+			OtherSquad->Alert(Character, ScoutBuff);
+		}
+	}
+}
+
+void AEnemy::OnSquadAlerted()
+{
+	if (bDying || !Squad) return;
+
+	// Replaces the bonus of an earlier alert instead of stacking on it
+	const FSquadBuff& Buff = Squad->GetBuff();
+	GetCharacterMovement()->MaxWalkSpeed += Buff.WalkSpeedBonus - SquadWalkSpeedBonus;
+	SquadWalkSpeedBonus = Buff.WalkSpeedBonus;
+	SquadDamageBonus = Buff.DamageBonus;
+	GetCharacterMovement()->RotationRate = FRotator(0.f, 120.f, 0.f);
+
+	if (InitiateAmbushSound && !GetWorldTimerManager().IsTimerActive(InitiateAmbushSoundTimer))
+	{
+		GetWorldTimerManager().SetTimer(
+			InitiateAmbushSoundTimer,
+			this,
+			&ThisClass::PlayInitiateAmbushSound,
+			FMath::RandRange(EnemyDetectedSoundCooldown + 1.0f, InitiateAmbushSoundCooldown)
+		);
 	}
 }
 
@@ -412,11 +508,16 @@ void AEnemy::SetStunned(bool Stunned)
 	
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("Stunned"), Stunned);
+		EnemyController->GetEnemyBlackboard().SetStunned(Stunned);
 	}
 }
 
 void AEnemy::CombatSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	OnCombatRangeEntered(OtherActor);
+}
+
+void AEnemy::OnCombatRangeEntered(AActor* OtherActor)
 {
 	if (bDying || !OtherActor) return;
 	auto Character = Cast<AShooterCharacter>(OtherActor);
@@ -426,14 +527,18 @@ void AEnemy::CombatSphereOverlap(UPrimitiveComponent* OverlappedComp, AActor* Ot
 		bInAttackRange = true;
 		if (EnemyController)
 		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("InAttackRange"), true);
+			EnemyController->GetEnemyBlackboard().SetInAttackRange(true);
 		}
 	}
 }
 
 void AEnemy::CombatSphereEndOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex)
 {
+	OnCombatRangeExited(OtherActor);
+}
 
+void AEnemy::OnCombatRangeExited(AActor* OtherActor)
+{
 	if (!OtherActor) return;
 	auto Character = Cast<AShooterCharacter>(OtherActor);
 
@@ -442,11 +547,18 @@ void AEnemy::CombatSphereEndOverlap(UPrimitiveComponent* OverlappedComp, AActor*
 		bInAttackRange = false;
 		if (EnemyController)
 		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("InAttackRange"), false);
+			EnemyController->GetEnemyBlackboard().SetInAttackRange(false);
 		}
 	}
 }
 
+bool AEnemy::IsInCombat() const
+{
+	if (bInAttackRange) return true;
+
+	return EnemyController && EnemyController->GetEnemyBlackboard().GetTargetActor() != nullptr;
+}
+
 void AEnemy::PlayAttackMontage(FName Section, float PlayRate)
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
@@ -464,7 +576,7 @@ void AEnemy::PlayAttackMontage(FName Section, float PlayRate)
 		AttackWaitTime);
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), false);
+		EnemyController->GetEnemyBlackboard().SetCanAttack(false);
 	}
 }
 
@@ -492,63 +604,87 @@ FName AEnemy::GetAttackSectionName()
 	return SectionName;
 }
 
-void AEnemy::OnLeftWeaponOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::OnWeaponHit(AActor* HitActor, FName SocketName)
 {
-	auto Character = Cast<AShooterCharacter>(OtherActor);
+	auto Character = Cast<AShooterCharacter>(HitActor);
 	if (Character)
 	{
-		float AbsoluteDamage = DoDamage(Character);		
+		++NumMeleeHits;
+
+		float AbsoluteDamage = DoDamage(Character);
+
 		//Spawn Armor Negate Effect VFX
 		if (AbsoluteDamage <= 0.f)
 		{
-			ShowArmorNegation(Character, LeftWeaponSocket);
+			ShowArmorNegation(Character, SocketName);
 			return;
 		}
 
-		SpawnBlood(Character, LeftWeaponSocket);
+		SpawnBlood(Character, SocketName);
 		StunCharacter(Character);
 	}
 }
 
-void AEnemy::OnRightWeaponOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::SweepWeapons()
 {
-	auto Character = Cast<AShooterCharacter>(OtherActor);
-	if (Character)
-	{
-		float AbsoluteDamage = DoDamage(Character);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EnemyWeaponSweep));
+	QueryParams.AddIgnoredActor(this);
 
-		//Spawn Armor Negate Effect VFX
-		if (AbsoluteDamage <= 0.f)
-		{
-			ShowArmorNegation(Character, RightWeaponSocket);
-			return;
-		}
+	TArray<FHitResult> Hits;
+	LeftWeaponSweep.Sweep(GetMesh(), QueryParams, Hits);
+	const int32 NumLeftHits{ Hits.Num() };
+	RightWeaponSweep.Sweep(GetMesh(), QueryParams, Hits);
 
-		SpawnBlood(Character, RightWeaponSocket);
-		StunCharacter(Character);
+	for (int32 Index = 0; Index < Hits.Num(); ++Index)
+	{
+		if (bDying) return;
+		OnWeaponHit(Hits[Index].GetActor(), Index < NumLeftHits ? LeftWeaponSocket : RightWeaponSocket);
 	}
 }
 
+void AEnemy::StopWeaponSweeps()
+{
+	LeftWeaponSweep.Stop();
+	RightWeaponSweep.Stop();
+	UpdateTickEnabled();
+}
+
+void AEnemy::UpdateTickEnabled()
+{
+	SetActorTickEnabled(bImplementsReceiveTick || LeftWeaponSweep.IsActive() || RightWeaponSweep.IsActive());
+}
+
 void AEnemy::ActivateLeftWeapon()
 {
 	if (bDying) return;
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	LeftWeaponSweep.Start(GetMesh(), LeftWeaponBaseSocket, LeftWeaponSocket, LeftWeaponSweepRadius);
+	UpdateTickEnabled();
 }
 
 void AEnemy::DeActivateLeftWeapon()
 {
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	if (!LeftWeaponSweep.IsActive()) return;
+
+	// Cover the part of the swing since the last tick
+	SweepWeapons();
+	LeftWeaponSweep.Stop();
+	UpdateTickEnabled();
 }
 
 void AEnemy::ActivateRightWeapon()
 {
 	if (bDying) return;
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	RightWeaponSweep.Start(GetMesh(), RightWeaponBaseSocket, RightWeaponSocket, RightWeaponSweepRadius);
+	UpdateTickEnabled();
 }
 
 void AEnemy::DeActivateRightWeapon()
 {
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	if (!RightWeaponSweep.IsActive()) return;
+
+	SweepWeapons();
+	RightWeaponSweep.Stop();
+	UpdateTickEnabled();
 }
 
 float AEnemy::DoDamage(AShooterCharacter* Victim)
@@ -558,7 +694,7 @@ float AEnemy::DoDamage(AShooterCharacter* Victim)
 
 	const float AbsoluteDamage = UGameplayStatics::ApplyDamage(
 		Victim,
-		BaseDamage,
+		BaseDamage + SquadDamageBonus,
 		EnemyController,
 		this,
 		UDamageType::StaticClass()
@@ -566,10 +702,11 @@ float AEnemy::DoDamage(AShooterCharacter* Victim)
 
 	if (Victim->GetMeleeImpactSound())
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			this,
 			Victim->GetMeleeImpactSound(),
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Melee
 		);
 	}
 
@@ -585,8 +722,8 @@ void AEnemy::SpawnBlood(AShooterCharacter* Victim, FName SocketName)
 		const FTransform SocketTransform{ TipSocket->GetSocketTransform(GetMesh()) };
 		if (Victim->GetBloodParticles()) // Spawn Blood Particles
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(
-				GetWorld(),
+			UParticlePoolSubsystem::SpawnEmitterAtLocation(
+				this,
 				Victim->GetBloodParticles(),
 				SocketTransform
 			);
@@ -602,8 +739,8 @@ void AEnemy::ShowArmorNegation(AShooterCharacter* Victim, FName SocketName)
 		const FTransform SocketTransform{ TipSocket->GetSocketTransform(GetMesh()) };
 		if (Victim->GetArmorNegationParticles())
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(
-				GetWorld(),
+			UParticlePoolSubsystem::SpawnEmitterAtLocation(
+				this,
 				Victim->GetArmorNegationParticles(),
 				SocketTransform
 			);
@@ -628,7 +765,7 @@ void AEnemy::ResetCanAttack()
 	bCanAttack = true;
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CanAttack"), true);
+		EnemyController->GetEnemyBlackboard().SetCanAttack(true);
 	}
 }
 
@@ -645,10 +782,85 @@ void AEnemy::DestroyEnemy()
 	{
 		ResetExplosiveSlowMotion();
 	}
-	Destroy();
+
+	// Back to the pool for the next spawn, destroyed when the pool is full or disabled
+	UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(this);
+	if (!EnemyPool || !EnemyPool->Release(this))
+	{
+		Destroy();
+	}
 	// You can perform other tasks here that comes after enemy death
 }
 
+void AEnemy::DeactivateForPool()
+{
+	UnregisterFromSubsystems();
+	LeftWeaponSweep.Stop();
+	RightWeaponSweep.Stop();
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	if (EnemyController)
+	{
+		EnemyController->SetPooled(true);
+	}
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+	SetActorTickEnabled(false);
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+}
+
+void AEnemy::ResetForReuse(const FTransform& SpawnTransform)
+{
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	Health = MaxHealth;
+	bDying = false;
+	bStunned = false;
+	bCanHitReact = true;
+	bCanAttack = true;
+	bInAttackRange = false;
+
+	// Undo the scout buff and the alert rotation rate
+	const AEnemy* DefaultEnemy = GetClass()->GetDefaultObject<AEnemy>();
+	GetCharacterMovement()->MaxWalkSpeed = DefaultEnemy->GetCharacterMovement()->MaxWalkSpeed;
+	GetCharacterMovement()->RotationRate = DefaultEnemy->GetCharacterMovement()->RotationRate;
+	SquadWalkSpeedBonus = 0.f;
+	SquadDamageBonus = 0.f;
+
+	// Death paused the animations on the last frame of the death montage
+	GetMesh()->bPauseAnims = false;
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->Montage_Stop(0.f);
+	}
+	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
+	HideEmoteBubble();
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	GetMesh()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	UpdateTickEnabled();
+
+	if (EnemyController)
+	{
+		EnemyController->SetPooled(false);
+
+		const FEnemyBlackboard& Blackboard = EnemyController->GetEnemyBlackboard();
+		Blackboard.SetTargetActor(nullptr);
+		Blackboard.SetStunned(false);
+		Blackboard.SetDead(false);
+		Blackboard.SetInAttackRange(false);
+		Blackboard.SetCharacterDead(false);
+	}
+
+	RegisterWithSubsystems();
+	StartBehaviorTree();
+}
+
 void AEnemy::ApplyExplosiveSlowMotion(AActor* DamageCauser)
 {
 	if (bInExplosiveSlowMotion) return;
@@ -696,10 +908,11 @@ void AEnemy::PlayEnemyDetectedSound()
 	// Play Enemy Detected Sound
 	if (EnemyDetectedSound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			GetWorld(),
 			EnemyDetectedSound,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Cue
 		);
 	}
 }
@@ -709,10 +922,11 @@ void AEnemy::PlayInitiateAmbushSound()
 	// Play Enemy Detected Sound
 	if (InitiateAmbushSound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			GetWorld(),
 			InitiateAmbushSound,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Cue
 		);
 	}
 }
@@ -721,10 +935,10 @@ void AEnemy::PlayMarkedExecutionDamageVFX()
 {
 	if (MarkedExecutionEffectParticles)
 	{
-		auto HeadboneLocation = GetMesh()->GetBoneLocation(*HeadBone);
+		auto HeadboneLocation = GetMesh()->GetBoneLocation(HeadBoneName);
 
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
+		UParticlePoolSubsystem::SpawnEmitterAtLocation(
+			this,
 			MarkedExecutionEffectParticles,
 			HeadboneLocation
 		);
@@ -737,12 +951,8 @@ void AEnemy::SetPatrolPointOne(FVector WorldPoint)
 
 	if (EnemyController)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("PatrolPoint Set"));
 		// Set 1st Patrol point Vector value to blackboard
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(
-			TEXT("PatrolPoint"),
-			PatrolPoint
-		);
+		EnemyController->GetEnemyBlackboard().SetPatrolPoint(PatrolPoint);
 	}
 }
 
@@ -753,19 +963,27 @@ void AEnemy::SetPatrolPointTwo(FVector WorldPoint)
 	if (EnemyController)
 	{
 		// Set 2nd Patrol point Vector value to blackboard
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(
-			TEXT("PatrolPoint2"),
-			PatrolPoint2
-		);
+		EnemyController->GetEnemyBlackboard().SetPatrolPoint2(PatrolPoint2);
 	}
 }
 
+void AEnemy::SetPatrolRoute(const FVector& WorldPointOne, const FVector& WorldPointTwo)
+{
+	if (!EnemyController) return;
+
+	EnemyController->GetEnemyBlackboard().SetPatrolPoint(WorldPointOne);
+	EnemyController->GetEnemyBlackboard().SetPatrolPoint2(WorldPointTwo);
+}
+
 // Called every frame
 void AEnemy::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	UpdateHitNumbers();
+	if (LeftWeaponSweep.IsActive() || RightWeaponSweep.IsActive())
+	{
+		SweepWeapons();
+	}
 }
 
 // Called to bind functionality to input
@@ -780,21 +998,21 @@ void AEnemy::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, ACo
 	// Do when linetrace of Player hits thie enemy
 	if (ImpactSound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			this,
 			ImpactSound,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Impact
 		);
 	}
 
 	if (ImpactParticles)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
+		UParticlePoolSubsystem::SpawnEmitterAtLocation(
+			this,
 			ImpactParticles,
 			HitResult.Location,
-			FRotator(0.f),
-			true
+			FRotator(0.f)
 		);
 	}
 }
@@ -805,10 +1023,10 @@ float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AC
 	if (EnemyController)
 	{
 		// Setting this Key in blackboard so the enemy can chase!
-		auto Character = Cast<AShooterCharacter>(EnemyController->GetBlackboardComponent()->GetValueAsObject(FName(TEXT("TargetActor"))));
+		auto Character = Cast<AShooterCharacter>(EnemyController->GetEnemyBlackboard().GetTargetActor());
 		if (!Character)
 		{
-			EnemyController->GetBlackboardComponent()->SetValueAsObject(FName("TargetActor"), DamageCauser);
+			EnemyController->GetEnemyBlackboard().SetTargetActor(DamageCauser);
 			//TODO: THIS IS A TEMP SOLUTION
 			GetCharacterMovement()->RotationRate = FRotator(0.f, 120.f, 0.f);
 		}
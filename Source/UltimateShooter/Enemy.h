@@ -5,8 +5,13 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "BulletHitInterface.h"
+#include "HitZone.h"
+#include "MeleeSweep.h"
+#include "EnemySignificance.h"
 #include "Enemy.generated.h"
 
+class UEnemySquad;
+
 UCLASS()
 class ULTIMATESHOOTER_API AEnemy : public ACharacter, public IBulletHitInterface
 {
@@ -41,13 +46,13 @@ protected:
 
 	void ResetHitReactTimer();
 
+	/** Gets a pooled hit number widget, null when the player controller has no hit number pool */
 	UFUNCTION(BlueprintCallable)
-	void StoreHitNumber(UUserWidget* HitNumber, FVector Location);
-
-	UFUNCTION()
-	void DestroyHitNumber(UUserWidget* HitNumber);
+	UUserWidget* AcquireHitNumber();
 
-	void UpdateHitNumbers();
+	/** Hands a hit number to the hit number subsystem for HitNumberDestroyTime */
+	UFUNCTION(BlueprintCallable)
+	void StoreHitNumber(UUserWidget* HitNumber, FVector Location);
 
 	/** Called when something overlaps with the Agro Sphere */
 	UFUNCTION()
@@ -94,33 +99,18 @@ protected:
 		int OtherBodyIndex
 	);
 
-	UFUNCTION(BlueprintCallable)
-	void PlayAttackMontage(FName Section, float PlayRate = 1.0f);
+	/** Damages the character hit by a weapon sweep, SocketName is where the hit effects spawn */
+	void OnWeaponHit(AActor* HitActor, FName SocketName);
 
-	UFUNCTION(BlueprintPure) // Doesnt need an execution pin
-	FName GetAttackSectionName();
+	/** Sweeps the active weapons, called from Tick while a swing is active */
+	void SweepWeapons();
 
-	UFUNCTION()
-	void OnLeftWeaponOverlap(
-		UPrimitiveComponent* OverlappedComp,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult
-	);
+	void StopWeaponSweeps();
 
-	UFUNCTION()
-	void OnRightWeaponOverlap(
-		UPrimitiveComponent* OverlappedComp,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult
-	);
+	/** Ticks while a weapon is swinging or when Blueprint implements Event Tick */
+	void UpdateTickEnabled();
 
-	/** Activate/DeActivate Weapon Collision */
+	/** Activate/DeActivate Weapon Sweeps, called by the attack montage notifies */
 	UFUNCTION(BlueprintCallable)
 	void ActivateLeftWeapon();
 	
@@ -162,11 +152,12 @@ protected:
 
 	void PlayMarkedExecutionDamageVFX();
 
-	UFUNCTION(BlueprintCallable)
-	void SetPatrolPointOne(FVector WorldPoint);
+	/** Perception, significance, squad and overlap bindings, undone by Die */
+	void RegisterWithSubsystems();
+	void UnregisterFromSubsystems();
 
-	UFUNCTION(BlueprintCallable)
-	void SetPatrolPointTwo(FVector WorldPoint);
+	/** Writes the start keys and patrol points to the blackboard and (re)starts the behavior tree */
+	void StartBehaviorTree();
 
 private:
 
@@ -186,9 +177,23 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float MaxHealth;
 
+	/** Head zone used when there is no HitZoneTable */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	FString HeadBone;
 
+	FName HeadBoneName;
+
+	/** Bone to zone table of this archetype (FHitZoneTable rows) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UDataTable* HitZoneTable;
+
+	/** Drawn instanced for this enemy while it is a far away horde member, none leaves horde members undrawn */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Horde", meta = (AllowPrivateAccess = "true"))
+	class UStaticMesh* HordeProxyMesh;
+
+	/** Zone of every bone of the mesh, built in BeginPlay */
+	FHitZoneLookup HitZones;
+
 	/** Time to Display HP Bar once attacked */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float HealthBarDisplayTime;
@@ -212,10 +217,6 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float HitReactTimeMax;
 
-	/** Map to store hit widgets and their locations */
-	UPROPERTY(VisibleAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	TMap<UUserWidget*, FVector> HitNumbers;
-
 	/** Time before a hit number is removed */
 	UPROPERTY(EditAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float HitNumberDestroyTime;
@@ -234,6 +235,10 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Behavior Tree", meta = (AllowPrivateAccess = "true", MakeEditWidget = "true"))
 	FVector PatrolPoint2;
 
+	/** Patrol between points handed out by the patrol route subsystem instead of PatrolPoint and PatrolPoint2, for spawned waves */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Behavior Tree", meta = (AllowPrivateAccess = "true"))
+	bool bUsePatrolRoute;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Behavior Tree", meta = (AllowPrivateAccess = "true"))
 	class AEnemyController* EnemyController;
 
@@ -280,6 +285,17 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scout", meta = (AllowPrivateAccess = "true"))
 	float ScoutMaxRageDamageBonus;
 
+	/** Enemies with the same squad name share alerts, targets and scout buffs. None joins a scout's squad when it alerts nearby */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Squad", meta = (AllowPrivateAccess = "true"))
+	FName SquadName;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Squad", meta = (AllowPrivateAccess = "true"))
+	UEnemySquad* Squad;
+
+	/** Squad buff bonuses applied to this enemy, zero until its squad alerts it. Only responders are alerted */
+	float SquadWalkSpeedBonus;
+	float SquadDamageBonus;
+
 	/** True when playing Hit Animation */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
 	bool bStunned;
@@ -306,24 +322,43 @@ private:
 	FName AttackL;
 	FName AttackR;
 
-	/** Collision Volume for the Left Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* LeftWeaponCollision;
-
-	/** Collision Volume for the Right Weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	UBoxComponent* RightWeaponCollision;
-
 	/** Base damage of the enemy */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float BaseDamage;
 
+	/** Tip of the left weapon, where its sweep ends and its hit effects spawn */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	FName LeftWeaponSocket;
 
+	/** Tip of the right weapon, where its sweep ends and its hit effects spawn */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	FName RightWeaponSocket;
 
+	/** Where the left weapon's sweep starts */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FName LeftWeaponBaseSocket;
+
+	/** Where the right weapon's sweep starts */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FName RightWeaponBaseSocket;
+
+	/** Radius of the capsule swept along the left weapon, the half extent its collision box had */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float LeftWeaponSweepRadius;
+
+	/** Radius of the capsule swept along the right weapon, the half extent its collision box had */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float RightWeaponSweepRadius;
+
+	FMeleeSweep LeftWeaponSweep;
+	FMeleeSweep RightWeaponSweep;
+
+	/** Characters hit by this enemy's weapons, for the melee replay harness */
+	int32 NumMeleeHits;
+
+	/** Blueprint Event Tick needs the actor to tick all the time */
+	bool bImplementsReceiveTick;
+
 	/** True when enemy can attack */
 	UPROPERTY(VisibleAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bCanAttack;
@@ -342,6 +377,13 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bDying;
 
+	/** True when agro / scout / combat range come from the enemy perception subsystem instead of the spheres */
+	bool bRegisteredForPerception;
+
+	/** AI level of detail bucket, set by the enemy significance subsystem */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	EEnemySignificance Significance;
+
 	FTimerHandle DeathTimer;
 
 	/** Time until enemy's corpse vanishes from the world */
@@ -395,7 +437,7 @@ public:
 	virtual void BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController) override;
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
-	FORCEINLINE FString GetHeadBone() const { return HeadBone; }
+	FORCEINLINE FHitZoneInfo GetHitZone(FName BoneName) const { return HitZones.Find(GetMesh(), BoneName); }
 	
 	UFUNCTION(BlueprintImplementableEvent)
 		void ShowHitNumber(int32 Damage, FVector HitLocation, bool bHeadShot, bool bCriticalHit);
@@ -406,5 +448,66 @@ public:
 
 	void AlertEnemy();
 
-	FORCEINLINE int32 GetHealth() const { return Health; }
+	/** Public for the native attack task, which calls them without going through Blueprint */
+	UFUNCTION(BlueprintCallable)
+	void PlayAttackMontage(FName Section, float PlayRate = 1.0f);
+
+	UFUNCTION(BlueprintPure) // Doesnt need an execution pin
+	FName GetAttackSectionName();
+
+	/**
+	 * Patrols between two world points handed out by the patrol route subsystem. Only the blackboard is written:
+	 * PatrolPoint and PatrolPoint2 stay the placed offsets from the actor, which a pooled enemy goes back to when reused
+	 */
+	void SetPatrolRoute(const FVector& WorldPointOne, const FVector& WorldPointTwo);
+
+	UFUNCTION(BlueprintCallable)
+	void SetPatrolPointOne(FVector WorldPoint);
+
+	UFUNCTION(BlueprintCallable)
+	void SetPatrolPointTwo(FVector WorldPoint);
+
+	/** Hides the enemy and stops its behavior, movement and animation while it waits in the enemy pool */
+	void DeactivateForPool();
+
+	/** Brings a pooled enemy back at the transform as if freshly spawned: full health, no death, stun, montage or squad buff */
+	void ResetForReuse(const FTransform& SpawnTransform);
+
+	FORCEINLINE float GetHealth() const { return Health; }
+	FORCEINLINE float GetMaxHealth() const { return MaxHealth; }
+	FORCEINLINE void SetHealth(float NewHealth) { Health = FMath::Clamp(NewHealth, 0.f, MaxHealth); }
+
+	FORCEINLINE bool IsDying() const { return bDying; }
+
+	FORCEINLINE UAnimMontage* GetAttackMontage() const { return AttackMontage; }
+	FORCEINLINE int32 GetNumMeleeHits() const { return NumMeleeHits; }
+
+	FORCEINLINE UStaticMesh* GetHordeProxyMesh() const { return HordeProxyMesh; }
+
+	/** Perception handlers, called by the sphere overlaps or the enemy perception subsystem */
+	void OnAgroRangeEntered(AActor* OtherActor);
+	void OnScoutRangeEntered(AActor* OtherActor);
+	void OnCombatRangeEntered(AActor* OtherActor);
+	void OnCombatRangeExited(AActor* OtherActor);
+
+	FORCEINLINE USphereComponent* GetAgroSphere() const { return AgroSphere; }
+	FORCEINLINE USphereComponent* GetScoutSphere() const { return ScoutSphere; }
+	FORCEINLINE USphereComponent* GetCombatRangeSphere() const { return CombatRangeSphere; }
+
+	FORCEINLINE bool IsScouting() const { return bScouting; }
+
+	/** Scouts alert their squad, the other members respond unless bRespondToScouts is unset */
+	FORCEINLINE bool IsRespondingToScouts() const { return !bScouting && bRespondToScouts; }
+
+	FORCEINLINE UEnemySquad* GetSquad() const { return Squad; }
+	FORCEINLINE void SetSquad(UEnemySquad* NewSquad) { Squad = NewSquad; }
+
+	/** Called by the squad on the members responding to scouts when it is alerted: applies the squad buff and readies the ambush */
+	void OnSquadAlerted();
+
+	/** In attack range or has a target */
+	bool IsInCombat() const;
+
+	FORCEINLINE EEnemySignificance GetSignificance() const { return Significance; }
+	FORCEINLINE void SetSignificance(EEnemySignificance NewSignificance) { Significance = NewSignificance; }
 };
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyBlackboard.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "EnemyController.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+const FEnemyBlackboardKeys& FEnemyBlackboardKeys::Get(const UBlackboardData* BlackboardAsset)
+{
+	static FEnemyBlackboardKeys InvalidKeys;
+	static TMap<TWeakObjectPtr<const UBlackboardData>, FEnemyBlackboardKeys> KeysPerAsset;
+
+	if (!BlackboardAsset) return InvalidKeys;
+
+	if (const FEnemyBlackboardKeys* CachedKeys = KeysPerAsset.Find(BlackboardAsset))
+	{
+		return *CachedKeys;
+	}
+
+	// Drop the keys of unloaded assets before adding new ones
+	for (auto It = KeysPerAsset.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid()) It.RemoveCurrent();
+	}
+
+	FEnemyBlackboardKeys& Keys = KeysPerAsset.Add(BlackboardAsset);
+	Keys.TargetActor = BlackboardAsset->GetKeyID(TEXT("TargetActor"));
+	Keys.Stunned = BlackboardAsset->GetKeyID(TEXT("Stunned"));
+	Keys.Dead = BlackboardAsset->GetKeyID(TEXT("Dead"));
+	Keys.CanAttack = BlackboardAsset->GetKeyID(TEXT("CanAttack"));
+	Keys.InAttackRange = BlackboardAsset->GetKeyID(TEXT("InAttackRange"));
+	Keys.PatrolPoint = BlackboardAsset->GetKeyID(TEXT("PatrolPoint"));
+	Keys.PatrolPoint2 = BlackboardAsset->GetKeyID(TEXT("PatrolPoint2"));
+	Keys.CharacterDead = BlackboardAsset->GetKeyID(TEXT("CharacterDead"));
+	return Keys;
+}
+
+FEnemyBlackboard::FEnemyBlackboard(UBlackboardComponent* InComponent) :
+	Component(InComponent),
+	Keys(FEnemyBlackboardKeys::Get(InComponent ? InComponent->GetBlackboardAsset() : nullptr))
+{
+}
+
+void FEnemyBlackboard::SetTargetActor(TArrayView<const FEnemyBlackboard> Blackboards, AActor* Target)
+{
+	for (const FEnemyBlackboard& Blackboard : Blackboards)
+	{
+		if (Blackboard.Component) Blackboard.Component->PauseObserverNotifications();
+	}
+
+	for (const FEnemyBlackboard& Blackboard : Blackboards)
+	{
+		Blackboard.SetTargetActor(Target);
+	}
+
+	for (const FEnemyBlackboard& Blackboard : Blackboards)
+	{
+		if (Blackboard.Component) Blackboard.Component->ResumeObserverNotifications(true);
+	}
+}
+
+/**
+ * Benchmark: the blackboard accesses of a hit and an alert (read target, write target, write a bool),
+ * by name and through cached keys, on the blackboard of the first enemy controller in the world.
+ */
+static void BenchmarkBlackboard(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 NumAccesses{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1'000'000 };
+	if (!World || NumAccesses <= 0) return;
+
+	TActorIterator<AEnemyController> It(World);
+	UBlackboardComponent* Component = It ? It->GetBlackboardComponent() : nullptr;
+	if (!Component || !Component->GetBlackboardAsset())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Blackboard: needs an enemy with an initialized blackboard in the world"));
+		return;
+	}
+
+	const FEnemyBlackboard Blackboard(Component);
+	UObject* const OriginalTarget{ Component->GetValueAsObject(TEXT("TargetActor")) };
+	const bool bOriginalCanAttack{ Component->GetValueAsBool(TEXT("CanAttack")) };
+	AActor* const Target = *It;
+
+	// Only the key lookups are measured, behavior tree observers hear nothing until the values are restored
+	Component->PauseObserverNotifications();
+
+	const double NameStartTime{ FPlatformTime::Seconds() };
+	for (int32 Access = 0; Access < NumAccesses; ++Access)
+	{
+		if (!Component->GetValueAsObject(TEXT("TargetActor")))
+		{
+			Component->SetValueAsObject(TEXT("TargetActor"), Target);
+		}
+		Component->SetValueAsBool(TEXT("CanAttack"), (Access & 1) != 0);
+	}
+	const double NameTime{ FPlatformTime::Seconds() - NameStartTime };
+
+	const double KeyStartTime{ FPlatformTime::Seconds() };
+	for (int32 Access = 0; Access < NumAccesses; ++Access)
+	{
+		if (!Blackboard.GetTargetActor())
+		{
+			Blackboard.SetTargetActor(Target);
+		}
+		Blackboard.SetCanAttack((Access & 1) != 0);
+	}
+	const double KeyTime{ FPlatformTime::Seconds() - KeyStartTime };
+
+	Component->SetValueAsObject(TEXT("TargetActor"), OriginalTarget);
+	Component->SetValueAsBool(TEXT("CanAttack"), bOriginalCanAttack);
+	Component->ResumeObserverNotifications(false);
+
+	UE_LOG(LogTemp, Display, TEXT("Blackboard: %d accesses, by name %.3f ms, cached keys %.3f ms (%.1fx)"),
+		NumAccesses,
+		NameTime * 1000.0,
+		KeyTime * 1000.0,
+		KeyTime > 0.0 ? NameTime / KeyTime : 0.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkBlackboardCommand(
+	TEXT("us.Bench.Blackboard"),
+	TEXT("Times N (default 1 million) enemy blackboard accesses by key name against cached key IDs"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkBlackboard)
+);
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+
+class UBlackboardData;
+
+/** Key IDs of the enemy blackboard, resolved by name once per blackboard asset */
+struct FEnemyBlackboardKeys
+{
+	FBlackboard::FKey TargetActor = FBlackboard::InvalidKey;
+	FBlackboard::FKey Stunned = FBlackboard::InvalidKey;
+	FBlackboard::FKey Dead = FBlackboard::InvalidKey;
+	FBlackboard::FKey CanAttack = FBlackboard::InvalidKey;
+	FBlackboard::FKey InAttackRange = FBlackboard::InvalidKey;
+	FBlackboard::FKey PatrolPoint = FBlackboard::InvalidKey;
+	FBlackboard::FKey PatrolPoint2 = FBlackboard::InvalidKey;
+	FBlackboard::FKey CharacterDead = FBlackboard::InvalidKey;
+
+	/** Keys of the asset, from the cache after the first call */
+	static const FEnemyBlackboardKeys& Get(const UBlackboardData* BlackboardAsset);
+};
+
+/**
+ * Typed access to an enemy blackboard through cached key IDs, instead of looking keys up by name on every access.
+ * Held by the enemy controllers after they initialize their blackboard. Missing keys are skipped like name lookups.
+ */
+struct FEnemyBlackboard
+{
+	FEnemyBlackboard() = default;
+
+	/** Call after the blackboard is initialized with its asset */
+	explicit FEnemyBlackboard(UBlackboardComponent* InComponent);
+
+	FORCEINLINE bool IsValid() const { return Component != nullptr; }
+	FORCEINLINE UBlackboardComponent* GetComponent() const { return Component; }
+
+	FORCEINLINE AActor* GetTargetActor() const { return IsValid() ? Cast<AActor>(Component->GetValue<UBlackboardKeyType_Object>(Keys.TargetActor)) : nullptr; }
+
+	FORCEINLINE void SetTargetActor(AActor* Target) const { SetValue<UBlackboardKeyType_Object>(Keys.TargetActor, Target); }
+	FORCEINLINE void SetStunned(bool bStunned) const { SetValue<UBlackboardKeyType_Bool>(Keys.Stunned, bStunned); }
+	FORCEINLINE void SetDead(bool bDead) const { SetValue<UBlackboardKeyType_Bool>(Keys.Dead, bDead); }
+	FORCEINLINE void SetCanAttack(bool bCanAttack) const { SetValue<UBlackboardKeyType_Bool>(Keys.CanAttack, bCanAttack); }
+	FORCEINLINE void SetInAttackRange(bool bInAttackRange) const { SetValue<UBlackboardKeyType_Bool>(Keys.InAttackRange, bInAttackRange); }
+	FORCEINLINE void SetPatrolPoint(const FVector& Point) const { SetValue<UBlackboardKeyType_Vector>(Keys.PatrolPoint, Point); }
+	FORCEINLINE void SetPatrolPoint2(const FVector& Point) const { SetValue<UBlackboardKeyType_Vector>(Keys.PatrolPoint2, Point); }
+	FORCEINLINE void SetCharacterDead(bool bCharacterDead) const { SetValue<UBlackboardKeyType_Bool>(Keys.CharacterDead, bCharacterDead); }
+
+	/**
+	 * Sets the target of many enemies at once, e.g. for a squad wide alert.
+	 * Observer notifications are held until every blackboard is written, so behavior trees react once to the whole batch.
+	 */
+	static void SetTargetActor(TArrayView<const FEnemyBlackboard> Blackboards, AActor* Target);
+
+private:
+
+	template<class TDataClass>
+	FORCEINLINE void SetValue(FBlackboard::FKey KeyID, typename TDataClass::FDataType Value) const
+	{
+		if (Component) Component->SetValue<TDataClass>(KeyID, Value);
+	}
+
+	UBlackboardComponent* Component = nullptr;
+
+	FEnemyBlackboardKeys Keys;
+};
@@ -5,20 +5,88 @@
 #include "BehaviorTree/BehaviorTree.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BrainComponent.h"
 #include "Navigation/CrowdFollowingComponent.h"
+#include "Navigation/CrowdManager.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "Enemy.h"
+#include "ShooterBehaviorTreeComponent.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+static TAutoConsoleVariable<float> CVarCrowdUpdateInterval(
+	TEXT("us.AI.CrowdUpdateInterval"),
+	0.5f,
+	TEXT("Seconds between crowd avoidance updates of each enemy, 0 keeps the possess settings"));
+
+static TAutoConsoleVariable<float> CVarCrowdDensityRadius(
+	TEXT("us.AI.CrowdDensityRadius"),
+	500.f,
+	TEXT("Radius other enemies are counted in for the local crowd density"));
+
+static TAutoConsoleVariable<int32> CVarCrowdDenseCount(
+	TEXT("us.AI.CrowdDenseCount"),
+	6,
+	TEXT("Enemies within us.AI.CrowdDensityRadius from which a crowd counts as dense"));
+
+static TAutoConsoleVariable<float> CVarCrowdNearDistance(
+	TEXT("us.AI.CrowdNearDistance"),
+	1500.f,
+	TEXT("Enemies closer than this to the player avoid at full quality unless the crowd is dense"));
+
+static TAutoConsoleVariable<float> CVarCrowdFarDistance(
+	TEXT("us.AI.CrowdFarDistance"),
+	4000.f,
+	TEXT("Enemies beyond this distance from the player avoid at low quality"));
+
+namespace EnemyCrowd
+{
+	/** What each crowd avoidance level sets on the crowd following component */
+	struct FAvoidanceSettings
+	{
+		ECrowdAvoidanceQuality::Type Quality;
+		float CollisionQueryRange;
+		float SeparationWeight;
+	};
+
+	enum EAvoidanceLevel : int32
+	{
+		Near,
+		NearDense,
+		Mid,
+		Far
+	};
+
+	static const FAvoidanceSettings Levels[] =
+	{
+		// Near
+		{ ECrowdAvoidanceQuality::High, 500.f, 500.f },
+		// Near, dense: fewer neighbours per query, less push between packed agents
+		{ ECrowdAvoidanceQuality::Good, 350.f, 250.f },
+		// Mid
+		{ ECrowdAvoidanceQuality::Medium, 300.f, 200.f },
+		// Far
+		{ ECrowdAvoidanceQuality::Low, 200.f, 100.f }
+	};
+}
 
 
 AEnemyController::AEnemyController(const FObjectInitializer& ObjectInitializer):
-	Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdFollowingComponent>(TEXT("PathFollowingComponent")))
+	Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdFollowingComponent>(TEXT("PathFollowingComponent"))),
+	MaxCrowdAvoidanceQuality(ECrowdAvoidanceQuality::High),
+	CrowdAvoidanceLevel(INDEX_NONE)
 {
 	BlackboardComponent = CreateDefaultSubobject<UBlackboardComponent>(TEXT("BlackboardComponent"));
 	check(BlackboardComponent);
 
-	BehaviorTreeComponent = CreateDefaultSubobject<UBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
+	BehaviorTreeComponent = CreateDefaultSubobject<UShooterBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
 	check(BehaviorTreeComponent);
 
+	// RunBehaviorTree reuses the brain component instead of creating a plain one next to BehaviorTreeComponent
+	BrainComponent = BehaviorTreeComponent;
+
 }
 
 void AEnemyController::OnPossess(APawn* InPawn)
@@ -34,27 +102,148 @@ void AEnemyController::OnPossess(APawn* InPawn)
 		if (Enemy->GetBehaviorTree())
 		{
 			BlackboardComponent->InitializeBlackboard(*(Enemy->GetBehaviorTree()->BlackboardAsset));
+			EnemyBlackboard = FEnemyBlackboard(BlackboardComponent);
 		}
 
 		SetCrowdAttributes();
+
+		const float CrowdUpdateInterval{ CVarCrowdUpdateInterval.GetValueOnGameThread() };
+		if (CrowdUpdateInterval > 0.f)
+		{
+			// Random first delay spreads the updates of enemies spawned together over the interval
+			GetWorldTimerManager().SetTimer(
+				CrowdAvoidanceTimer,
+				this,
+				&AEnemyController::UpdateCrowdAvoidance,
+				CrowdUpdateInterval,
+				true,
+				FMath::FRandRange(0.f, CrowdUpdateInterval)
+			);
+		}
 	}
 
 }
 
+void AEnemyController::OnUnPossess()
+{
+	GetWorldTimerManager().ClearTimer(CrowdAvoidanceTimer);
+
+	Super::OnUnPossess();
+}
+
+void AEnemyController::ApplySignificance(float BehaviorTreeTickInterval, ECrowdAvoidanceQuality::Type CrowdAvoidanceQuality)
+{
+	// The component clamps the interval the tree schedules for itself, setting the tick interval here wouldn't outlast the next tick
+	if (UShooterBehaviorTreeComponent* ShooterBehaviorTree = Cast<UShooterBehaviorTreeComponent>(BehaviorTreeComponent))
+	{
+		ShooterBehaviorTree->SetMinTickInterval(BehaviorTreeTickInterval);
+	}
+
+	MaxCrowdAvoidanceQuality = CrowdAvoidanceQuality;
+
+	// Re-apply the current level under the new cap
+	if (CrowdAvoidanceLevel != INDEX_NONE)
+	{
+		const int32 Level{ CrowdAvoidanceLevel };
+		CrowdAvoidanceLevel = INDEX_NONE;
+		ApplyCrowdAvoidanceLevel(Level);
+	}
+}
+
+void AEnemyController::SetPooled(bool bPooled)
+{
+	UCrowdFollowingComponent* PathFollowComp = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent());
+	UCrowdManager* CrowdManager = UCrowdManager::GetCurrent(this);
+
+	if (bPooled)
+	{
+		StopMovement();
+		if (BrainComponent)
+		{
+			BrainComponent->StopLogic(TEXT("Pooled"));
+		}
+		GetWorldTimerManager().PauseTimer(CrowdAvoidanceTimer);
+
+		// Hidden enemies would still be avoided by the crowd
+		if (CrowdManager && PathFollowComp)
+		{
+			CrowdManager->UnregisterAgent(PathFollowComp);
+		}
+	}
+	else
+	{
+		if (CrowdManager && PathFollowComp)
+		{
+			CrowdManager->RegisterAgent(PathFollowComp);
+		}
+		GetWorldTimerManager().UnPauseTimer(CrowdAvoidanceTimer);
+	}
+}
+
 void AEnemyController::SetCrowdAttributes()
 {
 	UCrowdFollowingComponent* PathFollowComp = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent());
 	if (PathFollowComp)
 	{
-		PathFollowComp->SetCrowdAvoidanceQuality(ECrowdAvoidanceQuality::High);
-		PathFollowComp->SetCrowdCollisionQueryRange(500.f);
-		PathFollowComp->SetCrowdSeparationWeight(500.f, true);
+		const EnemyCrowd::FAvoidanceSettings& Settings = EnemyCrowd::Levels[EnemyCrowd::Near];
+		PathFollowComp->SetCrowdAvoidanceQuality(FMath::Min(Settings.Quality, MaxCrowdAvoidanceQuality));
+		PathFollowComp->SetCrowdCollisionQueryRange(Settings.CollisionQueryRange);
+		PathFollowComp->SetCrowdSeparationWeight(Settings.SeparationWeight, true);
 		PathFollowComp->SetAcceptanceRadius(1000.f);
 		PathFollowComp->SetBlockDetection(300.f, 3.f, 12);
 		PathFollowComp->SetCrowdAnticipateTurns(true, true);
 		PathFollowComp->SetCrowdSeparation(true, true);
 		PathFollowComp->SetBlockDetectionState(true);
 
-		UE_LOG(LogTemp, Warning, TEXT("AI Possed!"));
+		CrowdAvoidanceLevel = EnemyCrowd::Near;
 	}
 }
+
+void AEnemyController::UpdateCrowdAvoidance()
+{
+	const APawn* ControlledPawn = GetPawn();
+	if (!ControlledPawn) return;
+
+	const FVector Location{ ControlledPawn->GetActorLocation() };
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	const float DistanceSquared{ Player ? FVector::DistSquared(Location, Player->GetActorLocation()) : TNumericLimits<float>::Max() };
+
+	int32 Level{ EnemyCrowd::Far };
+	if (DistanceSquared < FMath::Square(CVarCrowdNearDistance.GetValueOnGameThread()))
+	{
+		// Density only matters close to the player, further away the quality is already reduced
+		int32 NumNeighbours{ 0 };
+		UEnemyPerceptionSubsystem* Perception = UEnemyPerceptionSubsystem::Get(this);
+		if (Perception && UEnemyPerceptionSubsystem::IsPerceptionEnabled())
+		{
+			TArray<AEnemy*> Neighbours;
+			Perception->QueryEnemiesInRadius(Location, CVarCrowdDensityRadius.GetValueOnGameThread(), Neighbours);
+			NumNeighbours = Neighbours.Num() - 1; // Without this enemy
+		}
+
+		Level = NumNeighbours >= CVarCrowdDenseCount.GetValueOnGameThread() ? EnemyCrowd::NearDense : EnemyCrowd::Near;
+	}
+	else if (DistanceSquared < FMath::Square(CVarCrowdFarDistance.GetValueOnGameThread()))
+	{
+		Level = EnemyCrowd::Mid;
+	}
+
+	ApplyCrowdAvoidanceLevel(Level);
+}
+
+void AEnemyController::ApplyCrowdAvoidanceLevel(int32 Level)
+{
+	if (Level == CrowdAvoidanceLevel) return;
+
+	UCrowdFollowingComponent* PathFollowComp = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent());
+	if (!PathFollowComp) return;
+
+	CrowdAvoidanceLevel = Level;
+
+	// Each setter pushes the agent params to the crowd manager, so they only run on a change of level
+	const EnemyCrowd::FAvoidanceSettings& Settings = EnemyCrowd::Levels[Level];
+	PathFollowComp->SetCrowdAvoidanceQuality(FMath::Min(Settings.Quality, MaxCrowdAvoidanceQuality));
+	PathFollowComp->SetCrowdCollisionQueryRange(Settings.CollisionQueryRange);
+	PathFollowComp->SetCrowdSeparationWeight(Settings.SeparationWeight, true);
+}
@@ -4,8 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "EnemyBlackboard.h"
 #include "Runtime/AIModule/Classes/DetourCrowdAIController.h"
 #include "DetourCrowdAIController.h"
+#include "Navigation/CrowdFollowingComponent.h"
 #include "EnemyController.generated.h"
 
 /**
@@ -20,14 +22,34 @@ public:
 
 	AEnemyController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 	virtual void OnPossess(APawn* InPawn) override;	 
+	virtual void OnUnPossess() override;
+
+	/** Throttles the behavior tree for the enemy's significance bucket, and caps its crowd avoidance quality */
+	void ApplySignificance(float BehaviorTreeTickInterval, ECrowdAvoidanceQuality::Type CrowdAvoidanceQuality);
+
+	/** Stops the behavior tree and takes the enemy out of the crowd while it waits in the enemy pool, and puts it back */
+	void SetPooled(bool bPooled);
 
 protected:
 
 	UFUNCTION(BlueprintCallable)
 		void SetCrowdAttributes();
 
+	/** Picks avoidance quality, query range and separation weight from the local density and the distance to the player */
+	void UpdateCrowdAvoidance();
+
+	void ApplyCrowdAvoidanceLevel(int32 Level);
+
 private:
 
+	/** Highest avoidance quality the significance bucket allows */
+	ECrowdAvoidanceQuality::Type MaxCrowdAvoidanceQuality;
+
+	/** Crowd avoidance level in use, INDEX_NONE before the first update */
+	int32 CrowdAvoidanceLevel;
+
+	FTimerHandle CrowdAvoidanceTimer;
+
 	/** Blackboard for this enemy */
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 	class UBlackboardComponent* BlackboardComponent;
@@ -36,9 +58,15 @@ private:
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 	class UBehaviorTreeComponent* BehaviorTreeComponent;
 
+	/** Blackboard with its key IDs resolved */
+	FEnemyBlackboard EnemyBlackboard;
+
 public:
 
 	FORCEINLINE UBlackboardComponent* GetBlackboardComponent() const { return BlackboardComponent; }
 
+	/** Typed access to the blackboard, valid once an enemy is possessed */
+	FORCEINLINE const FEnemyBlackboard& GetEnemyBlackboard() const { return EnemyBlackboard; }
+
 
 };
@@ -0,0 +1,372 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPerceptionSubsystem.h"
+#include "Enemy.h"
+#include "ShooterCharacter.h"
+#include "Components/SphereComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Enemy Perception"), STAT_UpdateEnemyPerception, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Agents Evaluated"), STAT_PerceptionAgentsEvaluated, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<int32> CVarPerceptionEnabled(
+	TEXT("us.Perception.Enabled"),
+	1,
+	TEXT("1 runs enemy agro / scout / combat range through the perception subsystem, 0 uses overlap spheres. Read when enemies spawn"));
+
+static TAutoConsoleVariable<float> CVarPerceptionInterval(
+	TEXT("us.Perception.Interval"),
+	0.1f,
+	TEXT("Seconds between perception grid updates"));
+
+static TAutoConsoleVariable<float> CVarPerceptionLODDistance(
+	TEXT("us.Perception.LODDistance"),
+	4000.f,
+	TEXT("Enemies further than this from every player are evaluated every us.Perception.FarInterval seconds"));
+
+static TAutoConsoleVariable<float> CVarPerceptionFarInterval(
+	TEXT("us.Perception.FarInterval"),
+	0.5f,
+	TEXT("Seconds between evaluations of enemies beyond us.Perception.LODDistance"));
+
+static TAutoConsoleVariable<float> CVarPerceptionCellSize(
+	TEXT("us.Perception.CellSize"),
+	1000.f,
+	TEXT("Size of a perception grid cell"));
+
+void FPerceptionGrid::Reset(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 100.f);
+	for (TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+	{
+		Cell.Value.Reset();
+	}
+}
+
+void FPerceptionGrid::Add(int32 Index, const FVector& Location)
+{
+	Cells.FindOrAdd(GetCell(Location)).Add(Index);
+}
+
+bool UEnemyPerceptionSubsystem::IsPerceptionEnabled()
+{
+	return CVarPerceptionEnabled.GetValueOnGameThread() != 0;
+}
+
+void UEnemyPerceptionSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy) return;
+
+	FPerceptionAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Enemy = Enemy;
+	Agent.Location = Enemy->GetActorLocation();
+
+	// The spheres stay on the enemy as configuration
+	Agent.AgroRadius = Enemy->GetAgroSphere() ? Enemy->GetAgroSphere()->GetScaledSphereRadius() : 0.f;
+	Agent.ScoutRadius = Enemy->IsScouting() && Enemy->GetScoutSphere() ? Enemy->GetScoutSphere()->GetScaledSphereRadius() : 0.f;
+	Agent.CombatRadius = Enemy->GetCombatRangeSphere() ? Enemy->GetCombatRangeSphere()->GetScaledSphereRadius() : 0.f;
+
+	EnemyGrid.Add(Agents.Num() - 1, Agent.Location);
+}
+
+void UEnemyPerceptionSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	// Cleared here and compacted on the next grid rebuild, so handlers can unregister mid update
+	for (FPerceptionAgent& Agent : Agents)
+	{
+		if (Agent.Enemy.Get() == Enemy)
+		{
+			Agent.Enemy = nullptr;
+		}
+	}
+}
+
+void UEnemyPerceptionSubsystem::QueryEnemiesInRadius(const FVector& Center, float Radius, TArray<AEnemy*>& OutEnemies) const
+{
+	const float RadiusSquared{ FMath::Square(Radius) };
+	EnemyGrid.ForEachInRadius(Center, Radius, [&](int32 Index)
+	{
+		const FPerceptionAgent& Agent = Agents[Index];
+		AEnemy* Enemy = Agent.Enemy.Get();
+		if (Enemy && FVector::DistSquared(Agent.Location, Center) <= RadiusSquared)
+		{
+			OutEnemies.Add(Enemy);
+		}
+	});
+}
+
+UEnemyPerceptionSubsystem* UEnemyPerceptionSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UEnemyPerceptionSubsystem>() : nullptr;
+}
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	TimeUntilUpdate -= DeltaTime;
+	if (TimeUntilUpdate > 0.f) return;
+
+	TimeUntilUpdate = FMath::Max(CVarPerceptionInterval.GetValueOnGameThread(), 0.f);
+	UpdatePerception(GetWorld()->GetTimeSeconds());
+}
+
+ETickableTickType UEnemyPerceptionSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UEnemyPerceptionSubsystem::IsTickable() const
+{
+	return Agents.Num() > 0;
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyPerceptionSubsystem::UpdatePerception(float Now)
+{
+	SCOPE_CYCLE_COUNTER(STAT_UpdateEnemyPerception);
+
+	RebuildGrids();
+	if (Targets.Num() == 0) return;
+
+	// Agents registered by a handler are evaluated on the next update
+	const int32 NumAgents{ Agents.Num() };
+	for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+	{
+		if (Agents[AgentIndex].NextEvaluationTime <= Now)
+		{
+			EvaluateAgent(AgentIndex, Now);
+		}
+	}
+}
+
+void UEnemyPerceptionSubsystem::RebuildGrids()
+{
+	Agents.RemoveAll([](const FPerceptionAgent& Agent) { return !Agent.Enemy.IsValid(); });
+
+	const float CellSize{ CVarPerceptionCellSize.GetValueOnGameThread() };
+
+	EnemyGrid.Reset(CellSize);
+	for (int32 Index = 0; Index < Agents.Num(); ++Index)
+	{
+		FPerceptionAgent& Agent = Agents[Index];
+		Agent.Location = Agent.Enemy->GetActorLocation();
+		EnemyGrid.Add(Index, Agent.Location);
+	}
+
+	// Only the player character triggered the spheres
+	Targets.Reset();
+	TargetGrid.Reset(CellSize);
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		AShooterCharacter* Character = Iterator->IsValid() ? Cast<AShooterCharacter>((*Iterator)->GetPawn()) : nullptr;
+		if (Character)
+		{
+			TargetGrid.Add(Targets.Num(), Character->GetActorLocation());
+			Targets.Add({ Character, Character->GetActorLocation(), Character->GetSimpleCollisionRadius() });
+		}
+	}
+}
+
+void UEnemyPerceptionSubsystem::EvaluateAgent(int32 AgentIndex, float Now)
+{
+	INC_DWORD_STAT(STAT_PerceptionAgentsEvaluated);
+
+	FPerceptionAgent& Agent = Agents[AgentIndex];
+	AEnemy* Enemy = Agent.Enemy.Get();
+	if (!Enemy) return;
+
+	// Nearest target distance for LOD, and a target inside each range the way a sphere overlaps a capsule
+	const float MaxRadius{ FMath::Max3(Agent.AgroRadius, Agent.ScoutRadius, Agent.CombatRadius) };
+	const float LODDistance{ CVarPerceptionLODDistance.GetValueOnGameThread() };
+
+	float NearestDistance{ TNumericLimits<float>::Max() };
+	AActor* AgroTarget = nullptr;
+	AActor* ScoutTarget = nullptr;
+	AActor* CombatTarget = nullptr;
+
+	TargetGrid.ForEachInRadius(Agent.Location, FMath::Max(MaxRadius, LODDistance), [&](int32 TargetIndex)
+	{
+		const FPerceptionTarget& Target = Targets[TargetIndex];
+		const float Distance{ FVector::Dist(Agent.Location, Target.Location) };
+		NearestDistance = FMath::Min(NearestDistance, Distance);
+
+		if (!AgroTarget && Distance <= Agent.AgroRadius + Target.Radius) AgroTarget = Target.Actor.Get();
+		if (!ScoutTarget && Agent.ScoutRadius > 0.f && Distance <= Agent.ScoutRadius + Target.Radius) ScoutTarget = Target.Actor.Get();
+		if (!CombatTarget && Distance <= Agent.CombatRadius + Target.Radius) CombatTarget = Target.Actor.Get();
+	});
+
+	const bool bEnteredAgro{ AgroTarget && !Agent.bTargetInAgro };
+	const bool bEnteredScout{ ScoutTarget && !Agent.bTargetInScout };
+	const bool bEnteredCombat{ CombatTarget && !Agent.bTargetInCombat };
+	AActor* ExitedCombatTarget = !CombatTarget && Agent.bTargetInCombat ? Agent.CombatTarget.Get() : nullptr;
+
+	Agent.bTargetInAgro = AgroTarget != nullptr;
+	Agent.bTargetInScout = ScoutTarget != nullptr;
+	Agent.bTargetInCombat = CombatTarget != nullptr;
+	Agent.CombatTarget = CombatTarget;
+	Agent.NextEvaluationTime = NearestDistance > LODDistance ? Now + CVarPerceptionFarInterval.GetValueOnGameThread() : Now;
+
+	// Agent may be reallocated from here on
+	if (bEnteredAgro) Enemy->OnAgroRangeEntered(AgroTarget);
+	if (bEnteredScout) Enemy->OnScoutRangeEntered(ScoutTarget);
+	if (bEnteredCombat) Enemy->OnCombatRangeEntered(CombatTarget);
+	if (ExitedCombatTarget) Enemy->OnCombatRangeExited(ExitedCombatTarget);
+}
+
+/**
+ * Benchmark: N enemies with agro / scout / combat ranges wandering around one player.
+ * Times the perception grid update against moving the same number of actors carrying
+ * three overlap spheres and a capsule, which is what each enemy costs with the sphere approach.
+ */
+namespace PerceptionBenchmark
+{
+	static constexpr float AgroRadius{ 1500.f };
+	static constexpr float ScoutRadius{ 2500.f };
+	static constexpr float CombatRadius{ 150.f };
+	static constexpr float AreaExtent{ 15000.f };
+	static constexpr int32 NumFrames{ 30 };
+
+	static double RunGrid(int32 NumEnemies, FRandomStream& Random)
+	{
+		TArray<FVector> Locations;
+		for (int32 Index = 0; Index < NumEnemies; ++Index)
+		{
+			Locations.Add(FVector(Random.FRandRange(-AreaExtent, AreaExtent), Random.FRandRange(-AreaExtent, AreaExtent), 0.f));
+		}
+		TArray<bool> InRange;
+		InRange.Init(false, NumEnemies * 3);
+
+		const FVector PlayerLocation{ FVector::ZeroVector };
+		FPerceptionGrid EnemyGrid;
+		FPerceptionGrid TargetGrid;
+		int32 NumEvents{};
+
+		const double StartTime{ FPlatformTime::Seconds() };
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			EnemyGrid.Reset(CVarPerceptionCellSize.GetValueOnGameThread());
+			TargetGrid.Reset(CVarPerceptionCellSize.GetValueOnGameThread());
+			for (int32 Index = 0; Index < NumEnemies; ++Index)
+			{
+				Locations[Index] += FVector(Random.FRandRange(-30.f, 30.f), Random.FRandRange(-30.f, 30.f), 0.f);
+				EnemyGrid.Add(Index, Locations[Index]);
+			}
+			TargetGrid.Add(0, PlayerLocation);
+
+			for (int32 Index = 0; Index < NumEnemies; ++Index)
+			{
+				TargetGrid.ForEachInRadius(Locations[Index], ScoutRadius, [&](int32)
+				{
+					const float Distance{ FVector::Dist(Locations[Index], PlayerLocation) };
+					const float Radii[3]{ AgroRadius, ScoutRadius, CombatRadius };
+					for (int32 Range = 0; Range < 3; ++Range)
+					{
+						const bool bInRange{ Distance <= Radii[Range] };
+						NumEvents += bInRange != InRange[Index * 3 + Range] ? 1 : 0;
+						InRange[Index * 3 + Range] = bInRange;
+					}
+				});
+			}
+
+			// Scouts gathering allies
+			for (int32 Index = 0; Index < NumEnemies; Index += 10)
+			{
+				EnemyGrid.ForEachInRadius(Locations[Index], ScoutRadius, [&](int32 AllyIndex)
+				{
+					NumEvents += FVector::DistSquared(Locations[Index], Locations[AllyIndex]) <= FMath::Square(ScoutRadius) ? 1 : 0;
+				});
+			}
+		}
+		return (FPlatformTime::Seconds() - StartTime) / NumFrames;
+	}
+
+	static double RunSpheres(UWorld* World, int32 NumEnemies, FRandomStream& Random)
+	{
+		TArray<AActor*> Actors;
+		for (int32 Index = 0; Index < NumEnemies; ++Index)
+		{
+			const FVector Location{ Random.FRandRange(-AreaExtent, AreaExtent), Random.FRandRange(-AreaExtent, AreaExtent), 0.f };
+			AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location));
+			if (!Actor) continue;
+
+			UCapsuleComponent* Capsule = NewObject<UCapsuleComponent>(Actor);
+			Capsule->InitCapsuleSize(42.f, 96.f);
+			Capsule->SetCollisionProfileName(UCollisionProfile::Pawn_ProfileName);
+			Capsule->SetGenerateOverlapEvents(true);
+			Actor->SetRootComponent(Capsule);
+			Capsule->RegisterComponent();
+
+			for (float Radius : { AgroRadius, ScoutRadius, CombatRadius })
+			{
+				USphereComponent* Sphere = NewObject<USphereComponent>(Actor);
+				Sphere->InitSphereRadius(Radius);
+				Sphere->SetupAttachment(Capsule);
+				Sphere->RegisterComponent();
+			}
+			Actors.Add(Actor);
+		}
+
+		const double StartTime{ FPlatformTime::Seconds() };
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (AActor* Actor : Actors)
+			{
+				Actor->AddActorWorldOffset(FVector(Random.FRandRange(-30.f, 30.f), Random.FRandRange(-30.f, 30.f), 0.f));
+			}
+		}
+		const double FrameTime{ (FPlatformTime::Seconds() - StartTime) / NumFrames };
+
+		for (AActor* Actor : Actors)
+		{
+			Actor->Destroy();
+		}
+		return FrameTime;
+	}
+
+	static void Run(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World) return;
+
+		TArray<int32> EnemyCounts{ 50, 200, 1000 };
+		if (Args.Num() > 0)
+		{
+			TArray<FString> Counts;
+			Args[0].ParseIntoArray(Counts, TEXT(","));
+			EnemyCounts.Reset();
+			for (const FString& Count : Counts)
+			{
+				if (FCString::Atoi(*Count) > 0) EnemyCounts.Add(FCString::Atoi(*Count));
+			}
+		}
+
+		for (int32 NumEnemies : EnemyCounts)
+		{
+			FRandomStream Random(1337);
+			const double GridTime{ RunGrid(NumEnemies, Random) };
+			const double SphereTime{ RunSpheres(World, NumEnemies, Random) };
+
+			UE_LOG(LogTemp, Display, TEXT("Perception: %4d enemies, grid %.3f ms/update, spheres %.3f ms/frame (%.1fx)"),
+				NumEnemies,
+				GridTime * 1000.0,
+				SphereTime * 1000.0,
+				GridTime > 0.0 ? SphereTime / GridTime : 0.0);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkPerceptionCommand(
+	TEXT("us.Bench.Perception"),
+	TEXT("Compares the perception grid against moving overlap spheres for comma separated enemy counts (default 50,200,1000)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PerceptionBenchmark::Run)
+);
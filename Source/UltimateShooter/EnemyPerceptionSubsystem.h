@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+class AEnemy;
+
+/** Uniform grid on the XY plane, storing indices into an external array */
+struct FPerceptionGrid
+{
+	explicit FPerceptionGrid(float InCellSize = 1000.f) : CellSize(InCellSize) {}
+
+	/** Empties the cells, keeping them allocated */
+	void Reset(float InCellSize);
+
+	void Add(int32 Index, const FVector& Location);
+
+	/** Calls Func(Index) for everything in the cells touching the radius. Callers still check the distance */
+	template<typename FuncType>
+	void ForEachInRadius(const FVector& Center, float Radius, FuncType&& Func) const
+	{
+		const FIntPoint MinCell{ GetCell(Center - FVector(Radius)) };
+		const FIntPoint MaxCell{ GetCell(Center + FVector(Radius)) };
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				if (const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y)))
+				{
+					for (int32 Index : *Cell) Func(Index);
+				}
+			}
+		}
+	}
+
+private:
+
+	FORCEINLINE FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	float CellSize;
+
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
+
+/** An enemy registered for perception and what it currently perceives */
+struct FPerceptionAgent
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+	FVector Location = FVector::ZeroVector;
+
+	float AgroRadius = 0.f;
+	float ScoutRadius = 0.f;
+	float CombatRadius = 0.f;
+
+	bool bTargetInAgro = false;
+	bool bTargetInScout = false;
+	bool bTargetInCombat = false;
+
+	/** Target in combat range, handed to the exit handler when it leaves */
+	TWeakObjectPtr<AActor> CombatTarget;
+
+	/** World time of the next evaluation, pushed further out the further the enemy is from every target */
+	float NextEvaluationTime = 0.f;
+};
+
+/**
+ * Replaces the agro, scout and combat range overlap spheres of every enemy.
+ * Enemies and players are hashed into a uniform grid at a fixed rate, and each enemy runs its
+ * agro / scout / combat range checks as radius queries, less often the further it is from the player.
+ * Fires the same enter / exit handlers the sphere overlaps used, and only on change.
+ * Disabled with us.Perception.Enabled 0, which leaves enemies on their spheres.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UEnemyPerceptionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** True when enemies spawned now should register instead of using their spheres */
+	static bool IsPerceptionEnabled();
+
+	void RegisterEnemy(AEnemy* Enemy);
+
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Registered enemies within Radius of Center, from the last grid update */
+	void QueryEnemiesInRadius(const FVector& Center, float Radius, TArray<AEnemy*>& OutEnemies) const;
+
+	static UEnemyPerceptionSubsystem* Get(const UObject* WorldContextObject);
+
+	FORCEINLINE int32 GetNumAgents() const { return Agents.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	/** Rebuilds the grids and evaluates every agent that is due */
+	void UpdatePerception(float Now);
+
+private:
+
+	void RebuildGrids();
+
+	/** By index: handlers can register enemies, which reallocates the agents */
+	void EvaluateAgent(int32 AgentIndex, float Now);
+
+	TArray<FPerceptionAgent> Agents;
+
+	/** Location and collision radius of every player character */
+	struct FPerceptionTarget
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FVector Location;
+		float Radius;
+	};
+
+	TArray<FPerceptionTarget> Targets;
+
+	FPerceptionGrid EnemyGrid;
+	FPerceptionGrid TargetGrid;
+
+	float TimeUntilUpdate = 0.f;
+};
@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPoolSubsystem.h"
+#include "Enemy.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "UltimateShooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Spawned"), STAT_EnemiesSpawned, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Reused"), STAT_EnemiesReused, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Released"), STAT_EnemiesReleased, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<int32> CVarEnemyPoolEnabled(
+	TEXT("us.EnemyPool.Enabled"),
+	1,
+	TEXT("0 destroys dead enemies instead of pooling them"));
+
+static TAutoConsoleVariable<int32> CVarEnemyPoolMaxPerClass(
+	TEXT("us.EnemyPool.MaxPerClass"),
+	64,
+	TEXT("Max deactivated enemies kept per enemy class, dead enemies beyond it are destroyed"));
+
+AEnemy* UEnemyPoolSubsystem::SpawnEnemy(const UObject* WorldContextObject, TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform)
+{
+	UEnemyPoolSubsystem* EnemyPool = Get(WorldContextObject);
+	return EnemyPool ? EnemyPool->Acquire(EnemyClass, Transform) : nullptr;
+}
+
+AEnemy* UEnemyPoolSubsystem::Acquire(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform)
+{
+	if (!EnemyClass) return nullptr;
+
+	if (FEnemyClassPool* Pool = Pools.Find(EnemyClass))
+	{
+		while (Pool->Free.Num() > 0)
+		{
+			// Level streaming may have destroyed it
+			AEnemy* Enemy = Pool->Free.Pop(false);
+			if (!IsValid(Enemy)) continue;
+
+			INC_DWORD_STAT(STAT_EnemiesReused);
+			Enemy->ResetForReuse(Transform);
+			return Enemy;
+		}
+	}
+
+	INC_DWORD_STAT(STAT_EnemiesSpawned);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	return GetWorld()->SpawnActor<AEnemy>(EnemyClass, Transform, SpawnParams);
+}
+
+bool UEnemyPoolSubsystem::Release(AEnemy* Enemy)
+{
+	if (!IsValid(Enemy) || CVarEnemyPoolEnabled.GetValueOnGameThread() == 0) return false;
+
+	FEnemyClassPool& Pool = Pools.FindOrAdd(Enemy->GetClass());
+	if (Pool.Free.Num() >= CVarEnemyPoolMaxPerClass.GetValueOnGameThread()) return false;
+
+	INC_DWORD_STAT(STAT_EnemiesReleased);
+	Enemy->DeactivateForPool();
+	Pool.Free.Add(Enemy);
+	return true;
+}
+
+void UEnemyPoolSubsystem::Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count)
+{
+	if (!EnemyClass) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		AEnemy* Enemy = GetWorld()->SpawnActor<AEnemy>(EnemyClass, FTransform::Identity, SpawnParams);
+		if (!Release(Enemy))
+		{
+			if (Enemy) Enemy->Destroy();
+			return;
+		}
+	}
+}
+
+int32 UEnemyPoolSubsystem::GetNumFree() const
+{
+	int32 NumFree{ 0 };
+	for (const TPair<UClass*, FEnemyClassPool>& Pool : Pools)
+	{
+		NumFree += Pool.Value.Free.Num();
+	}
+	return NumFree;
+}
+
+UEnemyPoolSubsystem* UEnemyPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UEnemyPoolSubsystem>() : nullptr;
+}
+
+/**
+ * Soak test: spawns a batch of enemies around the player every frame and kills the previous batch
+ * the way DestroyEnemy does (back to the pool, or destroyed), until N enemies went through.
+ * Reports frame time hitches and memory growth. Run once with us.EnemyPool.Enabled 0 for the unpooled baseline.
+ */
+namespace EnemyPoolSoak
+{
+	static const TCHAR* DefaultEnemyClass{ TEXT("/Game/_Game/Enemies/Grux/BP_EnemyGrux.BP_EnemyGrux_C") };
+	static constexpr float SpawnRadius{ 2000.f };
+
+	/** Frames this much slower than the median count as hitches */
+	static constexpr float HitchFactor{ 2.f };
+
+	struct FSoakRun
+	{
+		TWeakObjectPtr<UWorld> World;
+		TSubclassOf<AEnemy> EnemyClass;
+		int32 NumRemaining = 0;
+		int32 BatchSize = 0;
+		int32 NumSpawned = 0;
+		TArray<TWeakObjectPtr<AEnemy>> Alive;
+		TArray<float> FrameTimes;
+		uint64 StartMemory = 0;
+		uint64 PeakMemory = 0;
+		FDelegateHandle TickerHandle;
+	};
+
+	static FSoakRun Run;
+
+	static void KillAlive()
+	{
+		UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(Run.World.Get());
+		for (const TWeakObjectPtr<AEnemy>& Enemy : Run.Alive)
+		{
+			if (!Enemy.IsValid()) continue;
+			if (!EnemyPool || !EnemyPool->Release(Enemy.Get()))
+			{
+				Enemy->Destroy();
+			}
+		}
+		Run.Alive.Reset();
+	}
+
+	static void Finish()
+	{
+		KillAlive();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		const uint64 EndMemory{ FPlatformMemory::GetStats().UsedPhysical };
+
+		TArray<float> SortedFrameTimes = Run.FrameTimes;
+		SortedFrameTimes.Sort();
+		const float MedianFrameTime{ SortedFrameTimes.Num() > 0 ? SortedFrameTimes[SortedFrameTimes.Num() / 2] : 0.f };
+		const float MaxFrameTime{ SortedFrameTimes.Num() > 0 ? SortedFrameTimes.Last() : 0.f };
+
+		int32 NumHitches{ 0 };
+		for (float FrameTime : Run.FrameTimes)
+		{
+			NumHitches += FrameTime > MedianFrameTime * HitchFactor ? 1 : 0;
+		}
+
+		const UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(Run.World.Get());
+		UE_LOG(LogTemp, Display, TEXT("EnemyPoolSoak: %d enemies over %d frames, pool %s (%d free)"),
+			Run.NumSpawned,
+			Run.FrameTimes.Num(),
+			CVarEnemyPoolEnabled.GetValueOnGameThread() != 0 ? TEXT("on") : TEXT("off"),
+			EnemyPool ? EnemyPool->GetNumFree() : 0);
+		UE_LOG(LogTemp, Display, TEXT("EnemyPoolSoak: frame median %.2f ms, max %.2f ms, %d hitches over %.1fx median"),
+			MedianFrameTime * 1000.f,
+			MaxFrameTime * 1000.f,
+			NumHitches,
+			HitchFactor);
+		UE_LOG(LogTemp, Display, TEXT("EnemyPoolSoak: memory %.1f MB -> %.1f MB after GC (%+.1f MB), peak %.1f MB"),
+			Run.StartMemory / (1024.0 * 1024.0),
+			EndMemory / (1024.0 * 1024.0),
+			((int64)EndMemory - (int64)Run.StartMemory) / (1024.0 * 1024.0),
+			Run.PeakMemory / (1024.0 * 1024.0));
+
+		Run = FSoakRun();
+	}
+
+	static bool Tick(float DeltaTime)
+	{
+		UWorld* World = Run.World.Get();
+		UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(World);
+		if (!EnemyPool)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyPoolSoak: world went away, aborted"));
+			Run = FSoakRun();
+			return false;
+		}
+
+		// The first frame carries the command itself
+		if (Run.NumSpawned > 0)
+		{
+			Run.FrameTimes.Add(DeltaTime);
+		}
+		Run.PeakMemory = FMath::Max(Run.PeakMemory, (uint64)FPlatformMemory::GetStats().UsedPhysical);
+
+		KillAlive();
+
+		if (Run.NumRemaining <= 0)
+		{
+			Finish();
+			return false;
+		}
+
+		const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+		const FVector Center{ Player ? Player->GetActorLocation() : FVector::ZeroVector };
+
+		const int32 NumToSpawn{ FMath::Min(Run.BatchSize, Run.NumRemaining) };
+		for (int32 Index = 0; Index < NumToSpawn; ++Index)
+		{
+			const FVector2D Offset{ FMath::RandPointInCircle(SpawnRadius) };
+			const FVector Location{ Center + FVector(Offset, 0.f) };
+			if (AEnemy* Enemy = EnemyPool->Acquire(Run.EnemyClass, FTransform(Location)))
+			{
+				Run.Alive.Add(Enemy);
+			}
+		}
+		Run.NumRemaining -= NumToSpawn;
+		Run.NumSpawned += NumToSpawn;
+		return true;
+	}
+
+	static void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World) return;
+		if (Run.TickerHandle.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyPoolSoak: already running"));
+			return;
+		}
+
+		const int32 NumEnemies{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2000 };
+		const int32 BatchSize{ Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20 };
+		UClass* EnemyClass = LoadClass<AEnemy>(nullptr, Args.Num() > 2 ? *Args[2] : DefaultEnemyClass);
+		if (!EnemyClass || NumEnemies <= 0 || BatchSize <= 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyPoolSoak: usage us.Bench.EnemyPoolSoak [Count] [BatchSize] [EnemyClassPath]"));
+			return;
+		}
+
+		Run.World = World;
+		Run.EnemyClass = EnemyClass;
+		Run.NumRemaining = NumEnemies;
+		Run.BatchSize = BatchSize;
+		Run.StartMemory = FPlatformMemory::GetStats().UsedPhysical;
+		Run.PeakMemory = Run.StartMemory;
+		Run.FrameTimes.Reserve(NumEnemies / BatchSize + 1);
+		Run.TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs EnemyPoolSoakCommand(
+	TEXT("us.Bench.EnemyPoolSoak"),
+	TEXT("Spawns and kills N enemies (default 2000), BatchSize per frame (default 20), and reports hitches and memory growth"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&EnemyPoolSoak::Start)
+);
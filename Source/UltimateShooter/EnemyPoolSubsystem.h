@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyPoolSubsystem.generated.h"
+
+class AEnemy;
+
+/** Deactivated enemies of one class */
+USTRUCT()
+struct FEnemyClassPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AEnemy*> Free;
+};
+
+/**
+ * Recycles dead enemies instead of destroying them, so a respawn keeps its controller, blackboard,
+ * behavior tree component and anim instance and only resets their state.
+ * Enemies return to the pool after their death timer, spawners get them back through SpawnEnemy.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Spawns an enemy from the pool of its class, or a new one when the pool is empty */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool", meta = (WorldContext = "WorldContextObject", DeterminesOutputType = "EnemyClass"))
+	static AEnemy* SpawnEnemy(const UObject* WorldContextObject, TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform);
+
+	AEnemy* Acquire(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform);
+
+	/** Deactivates the enemy into its pool, false when pooling is disabled or the pool is full and it should be destroyed */
+	bool Release(AEnemy* Enemy);
+
+	/** Spawns deactivated enemies ahead of time, e.g. behind a loading screen */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool")
+	void Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count);
+
+	int32 GetNumFree() const;
+
+	static UEnemyPoolSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+
+	UPROPERTY()
+	TMap<UClass*, FEnemyClassPool> Pools;
+};
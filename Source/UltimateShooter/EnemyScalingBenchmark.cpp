@@ -0,0 +1,402 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy.h"
+#include "EnemyPoolSubsystem.h"
+#include "ShooterBehaviorTreeComponent.h"
+#include "ShooterCharacter.h"
+#include "ShooterCrowdManager.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "NavigationSystem.h"
+#include "RenderCore.h"
+
+/**
+ * Benchmark: how the game scales with the number of enemies.
+ * Loads the benchmark map if needed, then for each enemy count spawns Grux and plain enemies around the player at
+ * the given density, holds the player's fire button, and records frame, game thread, AI and physics time and memory
+ * over a fixed number of frames. Writes one CSV row per count to Saved/Profiling/EnemyScaling.
+ * Runs headless and quits when done if unattended:
+ * UE4Editor UltimateShooter.uproject -game -nullrhi -unattended -ExecCmds="us.Bench.EnemyScaling 50,200,1000"
+ */
+namespace EnemyScalingBenchmark
+{
+	static const TCHAR* DefaultMap{ TEXT("/Game/_Game/Maps/DefaultMap") };
+	static const TCHAR* EnemyClassPaths[] =
+	{
+		TEXT("/Game/_Game/Enemies/Grux/BP_EnemyGrux.BP_EnemyGrux_C"),
+		TEXT("/Game/_Game/Enemies/Grux/BP_Enemy.BP_Enemy_C")
+	};
+
+	/** Enemies spawn outside this radius, so the first frames aren't spent in melee */
+	static constexpr float MinPlayerDistance{ 800.f };
+
+	/** Frames left out after each spawn while enemies start their trees and settle onto the navmesh */
+	static constexpr int32 WarmupFrames{ 60 };
+
+	/** Ticks in TG_StartPhysics and TG_EndPhysics, the time between the two is the frame's physics time */
+	struct FPhysicsTimerTickFunction : public FTickFunction
+	{
+		double* StartTime = nullptr;
+		double* PhysicsSeconds = nullptr;
+		bool bEnd = false;
+
+		virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override
+		{
+			if (bEnd)
+			{
+				*PhysicsSeconds += FPlatformTime::Seconds() - *StartTime;
+			}
+			else
+			{
+				*StartTime = FPlatformTime::Seconds();
+			}
+		}
+
+		virtual FString DiagnosticMessage() override { return TEXT("EnemyScalingBenchmark physics timer"); }
+	};
+
+	/** Averages over the measured frames of one enemy count */
+	struct FScalingSample
+	{
+		int32 NumEnemies = 0;
+		float FrameMs = 0.f;
+		float MaxFrameMs = 0.f;
+		float GameThreadMs = 0.f;
+		float AIMs = 0.f;
+		float PhysicsMs = 0.f;
+		float MemoryMB = 0.f;
+	};
+
+	enum class EPhase : uint8
+	{
+		LoadingMap,
+		Warmup,
+		Measuring
+	};
+
+	struct FScalingRun
+	{
+		FString MapName;
+		TArray<int32> Counts;
+		float Density = 2.f;
+		int32 NumFrames = 300;
+
+		EPhase Phase = EPhase::LoadingMap;
+		int32 CountIndex = 0;
+		int32 Frame = 0;
+		TWeakObjectPtr<UWorld> World;
+		TArray<TWeakObjectPtr<AEnemy>> Enemies;
+
+		double PhysicsStartTime = 0.0;
+		double PhysicsSeconds = 0.0;
+		double CrowdStartSeconds = 0.0;
+
+		FScalingSample Sample;
+		TArray<FScalingSample> Samples;
+		FDelegateHandle TickerHandle;
+	};
+
+	static FScalingRun Run;
+
+	/** Outside the run, tick functions can't be copied */
+	static FPhysicsTimerTickFunction PhysicsStartTick;
+	static FPhysicsTimerTickFunction PhysicsEndTick;
+
+	static UWorld* FindGameWorld()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+			{
+				return Context.World();
+			}
+		}
+		return nullptr;
+	}
+
+	static bool IsBenchmarkMap(const UWorld* World)
+	{
+		return UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()) == Run.MapName;
+	}
+
+	static double GetCrowdTickSeconds(UWorld* World)
+	{
+		UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+		const UShooterCrowdManager* CrowdManager = NavSys ? Cast<UShooterCrowdManager>(NavSys->GetCrowdManager()) : nullptr;
+		return CrowdManager ? CrowdManager->GetTotalTickSeconds() : 0.0;
+	}
+
+	static void RegisterPhysicsTimers(UWorld* World)
+	{
+		PhysicsStartTick.StartTime = &Run.PhysicsStartTime;
+		PhysicsStartTick.PhysicsSeconds = &Run.PhysicsSeconds;
+		PhysicsStartTick.TickGroup = TG_StartPhysics;
+		PhysicsStartTick.bCanEverTick = true;
+		PhysicsStartTick.RegisterTickFunction(World->PersistentLevel);
+
+		// Physics starts after the start timer, and the end timer waits for the results
+		World->StartPhysicsTickFunction.AddPrerequisite(World, PhysicsStartTick);
+
+		PhysicsEndTick.StartTime = &Run.PhysicsStartTime;
+		PhysicsEndTick.PhysicsSeconds = &Run.PhysicsSeconds;
+		PhysicsEndTick.bEnd = true;
+		PhysicsEndTick.TickGroup = TG_EndPhysics;
+		PhysicsEndTick.bCanEverTick = true;
+		PhysicsEndTick.AddPrerequisite(World, World->EndPhysicsTickFunction);
+		PhysicsEndTick.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	static void UnregisterPhysicsTimers(UWorld* World)
+	{
+		if (World)
+		{
+			World->StartPhysicsTickFunction.RemovePrerequisite(World, PhysicsStartTick);
+			PhysicsEndTick.RemovePrerequisite(World, World->EndPhysicsTickFunction);
+		}
+		PhysicsStartTick.UnRegisterTickFunction();
+		PhysicsEndTick.UnRegisterTickFunction();
+	}
+
+	static void SetPlayerFiring(UWorld* World, bool bFiring)
+	{
+		if (AShooterCharacter* Player = Cast<AShooterCharacter>(UGameplayStatics::GetPlayerPawn(World, 0)))
+		{
+			// Released and pressed again every frame, so semi-automatic weapons keep firing too
+			Player->SetAutoFireHeld(false);
+			if (bFiring) Player->SetAutoFireHeld(true);
+		}
+	}
+
+	static void ReleaseEnemies()
+	{
+		UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(Run.World.Get());
+		for (const TWeakObjectPtr<AEnemy>& Enemy : Run.Enemies)
+		{
+			if (!Enemy.IsValid()) continue;
+			if (!EnemyPool || !EnemyPool->Release(Enemy.Get()))
+			{
+				Enemy->Destroy();
+			}
+		}
+		Run.Enemies.Reset();
+	}
+
+	static void SpawnEnemies(UWorld* World, int32 NumEnemies)
+	{
+		UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(World);
+		if (!EnemyPool) return;
+
+		TArray<UClass*, TInlineAllocator<2>> EnemyClasses;
+		for (const TCHAR* EnemyClassPath : EnemyClassPaths)
+		{
+			if (UClass* EnemyClass = LoadClass<AEnemy>(nullptr, EnemyClassPath))
+			{
+				EnemyClasses.Add(EnemyClass);
+			}
+		}
+		if (EnemyClasses.Num() == 0) return;
+
+		// Density is enemies per 10 x 10 m, spread over a ring around the player
+		const float Area{ NumEnemies / Run.Density * 1000.f * 1000.f };
+		const float SpawnRadius{ FMath::Sqrt(Area / PI + FMath::Square(MinPlayerDistance)) };
+
+		const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+		const FVector Center{ Player ? Player->GetActorLocation() : FVector::ZeroVector };
+		for (int32 Index = 0; Index < NumEnemies; ++Index)
+		{
+			const float Angle{ FMath::FRand() * 2.f * PI };
+			const float Distance{ FMath::Sqrt(FMath::FRandRange(FMath::Square(MinPlayerDistance), FMath::Square(SpawnRadius))) };
+			const FVector Location{ Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance };
+			const FRotator Rotation{ 0.f, FMath::RadiansToDegrees(Angle) + 180.f, 0.f };
+			if (AEnemy* Enemy = EnemyPool->Acquire(EnemyClasses[Index % EnemyClasses.Num()], FTransform(Rotation, Location)))
+			{
+				Run.Enemies.Add(Enemy);
+			}
+		}
+	}
+
+	static void WriteCsv()
+	{
+		FString Csv{ TEXT("Enemies,FrameMs,MaxFrameMs,GameThreadMs,AIMs,PhysicsMs,MemoryMB\n") };
+		for (const FScalingSample& Sample : Run.Samples)
+		{
+			Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f\n"),
+				Sample.NumEnemies,
+				Sample.FrameMs,
+				Sample.MaxFrameMs,
+				Sample.GameThreadMs,
+				Sample.AIMs,
+				Sample.PhysicsMs,
+				Sample.MemoryMB);
+		}
+
+		const FString FileName{ FPaths::ProfilingDir() / TEXT("EnemyScaling") / FString::Printf(TEXT("EnemyScaling-%s.csv"), *FDateTime::Now().ToString()) };
+		if (FFileHelper::SaveStringToFile(Csv, *FileName))
+		{
+			UE_LOG(LogTemp, Display, TEXT("EnemyScaling: wrote %s"), *FPaths::ConvertRelativePathToFull(FileName));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyScaling: couldn't write %s"), *FileName);
+		}
+	}
+
+	static void Finish(bool bCompleted)
+	{
+		UWorld* World = Run.World.Get();
+		UnregisterPhysicsTimers(World);
+		if (World)
+		{
+			SetPlayerFiring(World, false);
+		}
+		ReleaseEnemies();
+
+		if (bCompleted)
+		{
+			WriteCsv();
+		}
+		Run = FScalingRun();
+
+		if (FApp::IsUnattended())
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	static void BeginCount(UWorld* World)
+	{
+		ReleaseEnemies();
+		SpawnEnemies(World, Run.Counts[Run.CountIndex]);
+
+		Run.Phase = EPhase::Warmup;
+		Run.Frame = 0;
+		Run.Sample = FScalingSample();
+		Run.Sample.NumEnemies = Run.Enemies.Num();
+	}
+
+	static void EndCount(UWorld* World)
+	{
+		const float NumFrames{ static_cast<float>(Run.NumFrames) };
+		FScalingSample& Sample = Run.Sample;
+		Sample.FrameMs /= NumFrames;
+		Sample.GameThreadMs /= NumFrames;
+		Sample.AIMs = (UShooterBehaviorTreeComponent::ConsumeTickSeconds() + GetCrowdTickSeconds(World) - Run.CrowdStartSeconds) * 1000.0 / NumFrames;
+		Sample.PhysicsMs = Run.PhysicsSeconds * 1000.0 / NumFrames;
+		Sample.MemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+		Run.Samples.Add(Sample);
+
+		UE_LOG(LogTemp, Display, TEXT("EnemyScaling: %d enemies, frame %.2f ms (max %.2f), game thread %.2f ms, AI %.2f ms, physics %.2f ms, memory %.0f MB"),
+			Sample.NumEnemies,
+			Sample.FrameMs,
+			Sample.MaxFrameMs,
+			Sample.GameThreadMs,
+			Sample.AIMs,
+			Sample.PhysicsMs,
+			Sample.MemoryMB);
+	}
+
+	static bool Tick(float DeltaTime)
+	{
+		if (Run.Phase == EPhase::LoadingMap)
+		{
+			UWorld* World = FindGameWorld();
+			if (!World || !IsBenchmarkMap(World) || !World->HasBegunPlay() || !UGameplayStatics::GetPlayerPawn(World, 0)) return true;
+
+			Run.World = World;
+			RegisterPhysicsTimers(World);
+			BeginCount(World);
+			return true;
+		}
+
+		UWorld* World = Run.World.Get();
+		if (!World)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyScaling: world went away, aborted"));
+			Finish(false);
+			return false;
+		}
+
+		SetPlayerFiring(World, true);
+
+		if (Run.Phase == EPhase::Warmup)
+		{
+			if (++Run.Frame < WarmupFrames) return true;
+
+			// Start from clean counters for the measured frames
+			Run.Phase = EPhase::Measuring;
+			Run.Frame = 0;
+			Run.PhysicsSeconds = 0.0;
+			Run.CrowdStartSeconds = GetCrowdTickSeconds(World);
+			UShooterBehaviorTreeComponent::ConsumeTickSeconds();
+			return true;
+		}
+
+		const float FrameMs{ DeltaTime * 1000.f };
+		Run.Sample.FrameMs += FrameMs;
+		Run.Sample.MaxFrameMs = FMath::Max(Run.Sample.MaxFrameMs, FrameMs);
+		Run.Sample.GameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+		if (++Run.Frame < Run.NumFrames) return true;
+
+		EndCount(World);
+		if (++Run.CountIndex < Run.Counts.Num())
+		{
+			BeginCount(World);
+			return true;
+		}
+
+		Finish(true);
+		return false;
+	}
+
+	static void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		if (Run.TickerHandle.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyScaling: already running"));
+			return;
+		}
+
+		TArray<FString> CountArgs;
+		(Args.Num() > 0 ? Args[0] : FString(TEXT("50,200,1000"))).ParseIntoArray(CountArgs, TEXT(","));
+		for (const FString& CountArg : CountArgs)
+		{
+			const int32 Count{ FCString::Atoi(*CountArg) };
+			if (Count > 0) Run.Counts.Add(Count);
+		}
+		Run.Density = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 2.f;
+		Run.NumFrames = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 300;
+		Run.MapName = Args.Num() > 3 ? Args[3] : DefaultMap;
+
+		if (Run.Counts.Num() == 0 || Run.Density <= 0.f || Run.NumFrames <= 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("EnemyScaling: usage us.Bench.EnemyScaling [Count,Count,...] [EnemiesPer10x10m] [Frames] [Map]"));
+			Run = FScalingRun();
+			return;
+		}
+
+		UWorld* GameWorld = World ? World : FindGameWorld();
+		if (!GameWorld || !IsBenchmarkMap(GameWorld))
+		{
+			UE_LOG(LogTemp, Display, TEXT("EnemyScaling: loading %s"), *Run.MapName);
+			GEngine->Exec(GameWorld, *FString::Printf(TEXT("open %s"), *Run.MapName));
+		}
+
+		Run.Phase = EPhase::LoadingMap;
+		Run.TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs EnemyScalingCommand(
+	TEXT("us.Bench.EnemyScaling"),
+	TEXT("Measures frame, game thread, AI and physics time and memory for each enemy count (default 50,200,1000) at a density (default 2 per 10 x 10 m) over F frames (default 300), and writes them to a CSV in Saved/Profiling"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&EnemyScalingBenchmark::Start)
+);
@@ -0,0 +1,12 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EEnemySignificance : uint8
+{
+	EES_Critical UMETA(DisplayName = "Critical"),
+	EES_High UMETA(DisplayName = "High"),
+	EES_Medium UMETA(DisplayName = "Medium"),
+	EES_Low UMETA(DisplayName = "Low"),
+
+	EES_MAX UMETA(DisplayName = "DefaultMAX")
+};
\ No newline at end of file
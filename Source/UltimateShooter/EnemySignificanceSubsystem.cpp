@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySignificanceSubsystem.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "ShooterBehaviorTreeComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Enemy Significance"), STAT_UpdateEnemySignificance, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Changes"), STAT_SignificanceChanges, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<float> CVarSignificanceInterval(
+	TEXT("us.AI.SignificanceInterval"),
+	0.25f,
+	TEXT("Seconds between enemy significance updates"));
+
+static TAutoConsoleVariable<float> CVarSignificanceNearDistance(
+	TEXT("us.AI.SignificanceNearDistance"),
+	1500.f,
+	TEXT("Enemies closer than this to the player camera are always critical"));
+
+static TAutoConsoleVariable<float> CVarSignificanceFarDistance(
+	TEXT("us.AI.SignificanceFarDistance"),
+	5000.f,
+	TEXT("Enemies beyond this distance from the player camera are at most medium, and low when not rendered"));
+
+namespace EnemySignificance
+{
+	/** What each bucket sets on the enemy, its mesh and its controller */
+	struct FBucketSettings
+	{
+		float ActorTickInterval;
+		float BehaviorTreeTickInterval;
+		bool bMeshUpdateRateOptimizations;
+		EVisibilityBasedAnimTickOption MeshTickOption;
+		ECrowdAvoidanceQuality::Type CrowdAvoidanceQuality;
+	};
+
+	static const FBucketSettings Buckets[(int32)EEnemySignificance::EES_MAX] =
+	{
+		// Critical
+		{ 0.f, 0.f, false, EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones, ECrowdAvoidanceQuality::High },
+		// High
+		{ 0.f, 0.f, true, EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones, ECrowdAvoidanceQuality::Good },
+		// Medium
+		{ 0.1f, 0.1f, true, EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered, ECrowdAvoidanceQuality::Medium },
+		// Low
+		{ 0.25f, 0.25f, true, EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered, ECrowdAvoidanceQuality::Low }
+	};
+
+	/** Rendered within this many seconds counts as visible */
+	static constexpr float RecentlyRenderedTolerance{ 0.5f };
+}
+
+void UEnemySignificanceSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (!Enemy) return;
+
+	// Enemies start out critical, which is what they are set up for. Pooled enemies come back in their last bucket
+	if (Enemy->GetSignificance() != EEnemySignificance::EES_Critical)
+	{
+		ApplySignificance(Enemy, EEnemySignificance::EES_Critical);
+	}
+	Enemies.AddUnique(Enemy);
+}
+
+void UEnemySignificanceSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	Enemies.RemoveSingleSwap(Enemy, false);
+}
+
+void UEnemySignificanceSubsystem::GetBucketPopulations(int32 (&OutPopulations)[(int32)EEnemySignificance::EES_MAX]) const
+{
+	FMemory::Memzero(OutPopulations);
+	for (const TWeakObjectPtr<AEnemy>& Enemy : Enemies)
+	{
+		if (Enemy.IsValid())
+		{
+			++OutPopulations[(int32)Enemy->GetSignificance()];
+		}
+	}
+}
+
+void UEnemySignificanceSubsystem::ConsumeBehaviorTreeTickRates(float (&OutTickRates)[(int32)EEnemySignificance::EES_MAX])
+{
+	int32 Populations[(int32)EEnemySignificance::EES_MAX];
+	FMemory::Memzero(Populations);
+	FMemory::Memzero(OutTickRates);
+
+	for (const TWeakObjectPtr<AEnemy>& Enemy : Enemies)
+	{
+		const AEnemyController* EnemyController = Enemy.IsValid() ? Enemy->GetEnemyController() : nullptr;
+		UShooterBehaviorTreeComponent* BehaviorTree = EnemyController ? Cast<UShooterBehaviorTreeComponent>(EnemyController->GetBrainComponent()) : nullptr;
+		if (!BehaviorTree) continue;
+
+		const int32 Bucket{ (int32)Enemy->GetSignificance() };
+		OutTickRates[Bucket] += BehaviorTree->ConsumeTickRate();
+		++Populations[Bucket];
+	}
+
+	for (int32 Bucket = 0; Bucket < (int32)EEnemySignificance::EES_MAX; ++Bucket)
+	{
+		if (Populations[Bucket] > 0)
+		{
+			OutTickRates[Bucket] /= Populations[Bucket];
+		}
+	}
+}
+
+UEnemySignificanceSubsystem* UEnemySignificanceSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UEnemySignificanceSubsystem>() : nullptr;
+}
+
+void UEnemySignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeUntilUpdate -= DeltaTime;
+	if (TimeUntilUpdate > 0.f) return;
+
+	TimeUntilUpdate = FMath::Max(CVarSignificanceInterval.GetValueOnGameThread(), 0.f);
+	UpdateSignificance();
+}
+
+ETickableTickType UEnemySignificanceSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UEnemySignificanceSubsystem::IsTickable() const
+{
+	return Enemies.Num() > 0;
+}
+
+TStatId UEnemySignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemySignificanceSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_UpdateEnemySignificance);
+
+	Enemies.RemoveAllSwap([](const TWeakObjectPtr<AEnemy>& Enemy) { return !Enemy.IsValid(); }, false);
+
+	TArray<FVector> ViewLocations;
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->PlayerCameraManager)
+		{
+			ViewLocations.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+	if (ViewLocations.Num() == 0) return;
+
+	for (const TWeakObjectPtr<AEnemy>& Enemy : Enemies)
+	{
+		const EEnemySignificance Significance{ EvaluateEnemy(Enemy.Get(), ViewLocations) };
+		if (Significance != Enemy->GetSignificance())
+		{
+			ApplySignificance(Enemy.Get(), Significance);
+		}
+	}
+}
+
+EEnemySignificance UEnemySignificanceSubsystem::EvaluateEnemy(const AEnemy* Enemy, const TArray<FVector>& ViewLocations) const
+{
+	if (Enemy->IsInCombat()) return EEnemySignificance::EES_Critical;
+
+	float DistanceSquared{ TNumericLimits<float>::Max() };
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		DistanceSquared = FMath::Min(DistanceSquared, FVector::DistSquared(ViewLocation, Enemy->GetActorLocation()));
+	}
+
+	if (DistanceSquared < FMath::Square(CVarSignificanceNearDistance.GetValueOnGameThread())) return EEnemySignificance::EES_Critical;
+
+	const bool bRendered{ Enemy->WasRecentlyRendered(EnemySignificance::RecentlyRenderedTolerance) };
+	const bool bFar{ DistanceSquared > FMath::Square(CVarSignificanceFarDistance.GetValueOnGameThread()) };
+
+	if (bRendered && !bFar) return EEnemySignificance::EES_High;
+	if (bRendered || !bFar) return EEnemySignificance::EES_Medium;
+	return EEnemySignificance::EES_Low;
+}
+
+void UEnemySignificanceSubsystem::ApplySignificance(AEnemy* Enemy, EEnemySignificance Significance)
+{
+	INC_DWORD_STAT(STAT_SignificanceChanges);
+
+	const EnemySignificance::FBucketSettings& Settings = EnemySignificance::Buckets[(int32)Significance];
+
+	Enemy->SetSignificance(Significance);
+	Enemy->SetActorTickInterval(Settings.ActorTickInterval);
+
+	if (USkeletalMeshComponent* Mesh = Enemy->GetMesh())
+	{
+		Mesh->bEnableUpdateRateOptimizations = Settings.bMeshUpdateRateOptimizations;
+		Mesh->VisibilityBasedAnimTickOption = Settings.MeshTickOption;
+	}
+
+	if (AEnemyController* EnemyController = Enemy->GetEnemyController())
+	{
+		EnemyController->ApplySignificance(Settings.BehaviorTreeTickInterval, Settings.CrowdAvoidanceQuality);
+	}
+}
+
+static FAutoConsoleCommandWithWorld DumpSignificanceCommand(
+	TEXT("us.AI.DumpSignificance"),
+	TEXT("Logs how many enemies are in each significance bucket, and the behavior tree tick rate they averaged since the last dump"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UEnemySignificanceSubsystem* Significance = World ? World->GetSubsystem<UEnemySignificanceSubsystem>() : nullptr;
+		if (!Significance) return;
+
+		int32 Populations[(int32)EEnemySignificance::EES_MAX];
+		Significance->GetBucketPopulations(Populations);
+
+		// Enemies that changed bucket since the last dump count towards the bucket they are in now
+		float TickRates[(int32)EEnemySignificance::EES_MAX];
+		Significance->ConsumeBehaviorTreeTickRates(TickRates);
+
+		const UEnum* SignificanceEnum = StaticEnum<EEnemySignificance>();
+		for (int32 Bucket = 0; Bucket < (int32)EEnemySignificance::EES_MAX; ++Bucket)
+		{
+			const EnemySignificance::FBucketSettings& Settings = EnemySignificance::Buckets[Bucket];
+			UE_LOG(LogTemp, Display, TEXT("Significance %-8s: %4d enemies (tick %.2fs, behavior tree %.2fs measured at %.1f Hz, URO %s, max crowd quality %d)"),
+				*SignificanceEnum->GetDisplayNameTextByIndex(Bucket).ToString(),
+				Populations[Bucket],
+				Settings.ActorTickInterval,
+				Settings.BehaviorTreeTickInterval,
+				TickRates[Bucket],
+				Settings.bMeshUpdateRateOptimizations ? TEXT("on") : TEXT("off"),
+				(int32)Settings.CrowdAvoidanceQuality);
+		}
+	})
+);
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EnemySignificance.h"
+#include "EnemySignificanceSubsystem.generated.h"
+
+class AEnemy;
+
+/**
+ * AI level of detail.
+ * A few times a second, sorts registered enemies into significance buckets by distance to the player camera,
+ * whether they were rendered recently and whether they are in combat. When an enemy changes bucket,
+ * its actor tick interval, behavior tree tick interval, mesh update rate optimisations and crowd avoidance quality follow.
+ * 'us.AI.DumpSignificance' logs the bucket populations, and the behavior tree tick rate measured in each bucket since the last dump.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UEnemySignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	void RegisterEnemy(AEnemy* Enemy);
+
+	/** Leaves the enemy in its current bucket */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Number of registered enemies in each bucket */
+	void GetBucketPopulations(int32 (&OutPopulations)[(int32)EEnemySignificance::EES_MAX]) const;
+
+	/** Average behavior tree ticks per second of the enemies in each bucket, since the last call */
+	void ConsumeBehaviorTreeTickRates(float (&OutTickRates)[(int32)EEnemySignificance::EES_MAX]);
+
+	static UEnemySignificanceSubsystem* Get(const UObject* WorldContextObject);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	/** Rebuckets every registered enemy */
+	void UpdateSignificance();
+
+	EEnemySignificance EvaluateEnemy(const AEnemy* Enemy, const TArray<FVector>& ViewLocations) const;
+
+	static void ApplySignificance(AEnemy* Enemy, EEnemySignificance Significance);
+
+	TArray<TWeakObjectPtr<AEnemy>> Enemies;
+
+	float TimeUntilUpdate = 0.f;
+};
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySquad.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "EnemySquadSubsystem.h"
+#include "UltimateShooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Squad Alerts"), STAT_SquadAlerts, STATGROUP_UltimateShooter);
+
+void UEnemySquad::AddMember(AEnemy* Enemy)
+{
+	if (!Enemy) return;
+
+	Members.AddUnique(Enemy);
+	Enemy->SetSquad(this);
+
+	// Joining an alerted squad alerts the new member too
+	RefreshAlertLevel();
+	if (AlertLevel == ESquadAlertLevel::ESAL_Alerted && Enemy->IsRespondingToScouts())
+	{
+		Enemy->OnSquadAlerted();
+		if (Enemy->GetEnemyController())
+		{
+			Enemy->GetEnemyController()->GetEnemyBlackboard().SetTargetActor(Target.Get());
+		}
+	}
+}
+
+void UEnemySquad::RemoveMember(AEnemy* Enemy)
+{
+	Members.RemoveSingleSwap(Enemy, false);
+	if (Enemy && Enemy->GetSquad() == this)
+	{
+		Enemy->SetSquad(nullptr);
+	}
+
+	// Dying and pooled enemies leave their squad, the last one out takes it off the subsystem
+	Members.RemoveAllSwap([](const TWeakObjectPtr<AEnemy>& Member) { return !Member.IsValid(); }, false);
+	if (Members.Num() == 0)
+	{
+		if (UEnemySquadSubsystem* EnemySquads = GetTypedOuter<UEnemySquadSubsystem>())
+		{
+			EnemySquads->RemoveSquad(this);
+		}
+	}
+}
+
+void UEnemySquad::Alert(AActor* NewTarget, const FSquadBuff& ScoutBuff)
+{
+	if (!NewTarget) return;
+
+	Members.RemoveAllSwap([](const TWeakObjectPtr<AEnemy>& Member) { return !Member.IsValid(); }, false);
+
+	// A squad that lost its target rolls a new buff on the next alert
+	RefreshAlertLevel();
+	if (AlertLevel == ESquadAlertLevel::ESAL_Idle)
+	{
+		Buff = ScoutBuff;
+	}
+	AlertLevel = ESquadAlertLevel::ESAL_Alerted;
+	Target = NewTarget;
+
+	// Members already hunting the target have nothing to update and nothing to stack
+	TArray<FEnemyBlackboard, TInlineAllocator<16>> MemberBlackboards;
+	for (const TWeakObjectPtr<AEnemy>& Member : Members)
+	{
+		if (!Member->IsRespondingToScouts() || !Member->GetEnemyController()) continue;
+
+		const FEnemyBlackboard& MemberBlackboard = Member->GetEnemyController()->GetEnemyBlackboard();
+		if (MemberBlackboard.GetTargetActor() == NewTarget) continue;
+
+		Member->OnSquadAlerted();
+		MemberBlackboards.Add(MemberBlackboard);
+	}
+	if (MemberBlackboards.Num() == 0) return;
+
+	INC_DWORD_STAT(STAT_SquadAlerts);
+	FEnemyBlackboard::SetTargetActor(MemberBlackboards, NewTarget);
+}
+
+void UEnemySquad::RefreshAlertLevel()
+{
+	if (AlertLevel != ESquadAlertLevel::ESAL_Alerted) return;
+
+	// Still alerted while any responder holds the target. The others lost it, or were pooled and reused
+	AActor* const CurrentTarget = Target.Get();
+	if (CurrentTarget)
+	{
+		for (const TWeakObjectPtr<AEnemy>& Member : Members)
+		{
+			const AEnemyController* EnemyController = Member.IsValid() && Member->IsRespondingToScouts() ? Member->GetEnemyController() : nullptr;
+			if (EnemyController && EnemyController->GetEnemyBlackboard().GetTargetActor() == CurrentTarget) return;
+		}
+	}
+
+	AlertLevel = ESquadAlertLevel::ESAL_Idle;
+	Target = nullptr;
+}
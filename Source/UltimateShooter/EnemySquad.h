@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "SquadAlertLevel.h"
+#include "EnemySquad.generated.h"
+
+class AEnemy;
+
+/** Bonuses a scout grants its squad. Rolled by the first alert, later alerts reuse it */
+struct FSquadBuff
+{
+	float DamageBonus = 0.f;
+	float WalkSpeedBonus = 0.f;
+};
+
+/**
+ * Enemies sharing an alert level, a target and a scout buff.
+ * Members read the squad instead of each being written to. Alerting the squad again only alerts the members that
+ * aren't after the target, and the buff is only rolled again once the squad lost its target, so boosts can't stack.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UEnemySquad : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	void AddMember(AEnemy* Enemy);
+
+	/** The squad is removed from its subsystem when the last member leaves */
+	void RemoveMember(AEnemy* Enemy);
+
+	/** Alerts the members responding to scouts that aren't already after the target, writing their blackboards in one batch */
+	void Alert(AActor* NewTarget, const FSquadBuff& ScoutBuff);
+
+	FORCEINLINE ESquadAlertLevel GetAlertLevel() const { return AlertLevel; }
+	FORCEINLINE AActor* GetTarget() const { return Target.Get(); }
+	FORCEINLINE const FSquadBuff& GetBuff() const { return Buff; }
+	FORCEINLINE int32 GetNumMembers() const { return Members.Num(); }
+	FORCEINLINE FName GetSquadKey() const { return SquadKey; }
+
+private:
+
+	friend class UEnemySquadSubsystem;
+
+	/** Goes back to idle once no responder holds the target anymore */
+	void RefreshAlertLevel();
+
+	TArray<TWeakObjectPtr<AEnemy>> Members;
+
+	/** SquadName the subsystem finds the squad by, None for a scout's ad-hoc squad */
+	FName SquadKey;
+
+	UPROPERTY(VisibleAnywhere, Category = "Squad")
+	ESquadAlertLevel AlertLevel = ESquadAlertLevel::ESAL_Idle;
+
+	TWeakObjectPtr<AActor> Target;
+
+	FSquadBuff Buff;
+};
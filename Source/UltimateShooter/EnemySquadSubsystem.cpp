@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySquadSubsystem.h"
+#include "EnemySquad.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+UEnemySquad* UEnemySquadSubsystem::FindOrCreateSquad(FName SquadName)
+{
+	if (SquadName.IsNone()) return nullptr;
+
+	UEnemySquad*& Squad = Squads.FindOrAdd(SquadName);
+	if (!Squad)
+	{
+		// A removed squad of the same name lives on until garbage collection, a fixed object name would reuse it
+		Squad = NewObject<UEnemySquad>(this, MakeUniqueObjectName(this, UEnemySquad::StaticClass(), SquadName));
+		Squad->SquadKey = SquadName;
+	}
+	return Squad;
+}
+
+UEnemySquad* UEnemySquadSubsystem::CreateScoutSquad(const AActor* Scout)
+{
+	const FName BaseName{ Scout ? Scout->GetFName() : NAME_None };
+	return NewObject<UEnemySquad>(this, MakeUniqueObjectName(this, UEnemySquad::StaticClass(), BaseName));
+}
+
+void UEnemySquadSubsystem::RemoveSquad(UEnemySquad* Squad)
+{
+	if (!Squad || Squad->SquadKey.IsNone()) return;
+
+	UEnemySquad** Existing = Squads.Find(Squad->SquadKey);
+	if (Existing && *Existing == Squad)
+	{
+		Squads.Remove(Squad->SquadKey);
+	}
+}
+
+UEnemySquadSubsystem* UEnemySquadSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UEnemySquadSubsystem>() : nullptr;
+}
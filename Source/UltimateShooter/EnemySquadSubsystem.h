@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemySquadSubsystem.generated.h"
+
+class UEnemySquad;
+class AActor;
+
+/** Owns the named squads of a world. Scouts' ad-hoc squads are kept alive by their members only */
+UCLASS()
+class ULTIMATESHOOTER_API UEnemySquadSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The squad enemies with this SquadName share */
+	UEnemySquad* FindOrCreateSquad(FName SquadName);
+
+	/** A new squad for a scout without one. It has no squad name, so it can't be joined by name or merge with a named squad */
+	UEnemySquad* CreateScoutSquad(const AActor* Scout);
+
+	/** Forgets the squad once its last member has left, an enemy joining by the same name later starts a new one */
+	void RemoveSquad(UEnemySquad* Squad);
+
+	static UEnemySquadSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+
+	UPROPERTY()
+	TMap<FName, UEnemySquad*> Squads;
+};
@@ -9,6 +9,9 @@
 #include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
 #include "ShooterCharacter.h"
+#include "ParticlePoolSubsystem.h"
+#include "CombatAudioSubsystem.h"
+#include "ExplosiveNetworkSubsystem.h"
 
 
 // Sets default values
@@ -17,8 +20,8 @@ AExplosive::AExplosive() :
 	ExplosionDelay(1.f),
 	ChainExplosionDelay(0.1f)
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Explosives only react to hits and to the explosive network, they don't tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	ExplosiveMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ExplosiveMesh"));
 	SetRootComponent(ExplosiveMesh);
@@ -32,146 +35,116 @@ void AExplosive::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	if (UExplosiveNetworkSubsystem* ExplosiveNetwork = UExplosiveNetworkSubsystem::Get(this))
+	{
+		ExplosiveNetwork->RegisterExplosive(this);
+		ExplosiveMesh->TransformUpdated.AddUObject(this, &AExplosive::OnTransformUpdated);
+	}
 }
 
-void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController)
+void AExplosive::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	// Do when linetrace of Player hits thie enemy
-	if (ImpactSound)
+	ExplosiveMesh->TransformUpdated.RemoveAll(this);
+	if (UExplosiveNetworkSubsystem* ExplosiveNetwork = UExplosiveNetworkSubsystem::Get(this))
 	{
-		UGameplayStatics::PlaySoundAtLocation(
-			this,
-			ImpactSound,
-			GetActorLocation()
-		);
+		ExplosiveNetwork->UnregisterExplosive(this);
 	}
 
-	if (ExplodeParticles)
+	Super::EndPlay(EndPlayReason);
+}
+
+void AExplosive::OnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UExplosiveNetworkSubsystem* ExplosiveNetwork = UExplosiveNetworkSubsystem::Get(this))
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
-			ExplodeParticles,
-			HitResult.Location,
-			FRotator(0.f),
-			true
-		);
+		ExplosiveNetwork->UpdateExplosive(this);
 	}
+}
 
-	// Apply Explosive Damage!!
-	TArray<AActor*> OverlappingActors;
-	GetOverlappingActors(OverlappingActors, ACharacter::StaticClass());
-
-	for (auto Actor : OverlappingActors)
+void AExplosive::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController)
+{
+	// Sets off every explosive in reach through the explosive network
+	if (UExplosiveNetworkSubsystem* ExplosiveNetwork = UExplosiveNetworkSubsystem::Get(this))
 	{
-		UGameplayStatics::ApplyDamage(
-			Actor,
-			Damage,
-			ShooterController,
-			Shooter,
-			UDamageType::StaticClass()
-		);
+		ExplosiveNetwork->Detonate(this, HitResult.Location, Shooter, ShooterController);
 	}
-
-	TArray<AActor*> OverlappingExplosives;
-	GetOverlappingActors(OverlappingExplosives, AExplosive::StaticClass());
-
-	float BlastDelay = ExplosionDelay;
-
-	for (auto Actor : OverlappingExplosives)
+	else
 	{
-		auto ExplosiveActor = Cast<AExplosive>(Actor);
-		if (ExplosiveActor)
-		{
-			TArray<AActor*> OverlappingExplodingActors;
-			ExplosiveActor->GetOverlappingActors(OverlappingExplodingActors, ACharacter::StaticClass());
-
-
-			for (auto ExplodingActor : OverlappingExplodingActors)
-			{
-				if (!ExplodingActor || !ExplosiveActor) continue;
-				FuseExplosive(
-					HitResult,
-					Shooter,
-					ShooterController,
-					ExplodingActor,
-					ExplosiveActor,
-					BlastDelay
-				);
-
-				BlastDelay += ChainExplosionDelay;
-			}
-		}
+		Explode(HitResult.Location, ShooterController, Shooter);
 	}
-
-	Destroy();
 }
 
-
-
-// Called every frame
-void AExplosive::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
-void AExplosive::DelayedExplosion(FHitResult HitResult, AActor* Shooter, AController* ShooterController, AActor* DamagedActor, AActor* ExplosiveActor)
+void AExplosive::Explode(const FVector& BlastLocation, AController* ShooterController, AActor* DamageCauser)
 {
-	// Do when linetrace of Player hits thie enemy
 	if (ImpactSound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			this,
 			ImpactSound,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Impact
 		);
 	}
 
 	if (ExplodeParticles)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
+		UParticlePoolSubsystem::SpawnEmitterAtLocation(
+			this,
 			ExplodeParticles,
-			GetActorLocation(),//HitResult.Location,
-			FRotator(0.f),
-			true
+			BlastLocation,
+			FRotator(0.f)
 		);
 	}
 
-	if (DamagedActor && this)
+	// Apply Explosive Damage!! Overlaps are unique, each character takes this blast once
+	TArray<AActor*> OverlappingActors;
+	GetOverlappingActors(OverlappingActors, ACharacter::StaticClass());
+
+	UBlastDamageSubsystem* BlastDamage = UBlastDamageSubsystem::Get(this);
+	if (!BlastDamage)
 	{
-		UGameplayStatics::ApplyDamage(
-			DamagedActor,
-			Damage,
-			ShooterController,
-			this, // This has changed from Actor to Explosive
-			UDamageType::StaticClass()
-		);
+		Destroy();
+		return;
+	}
+
+	// Occlusion traces apply the damage next frame, and a chained explosive is its own damage causer.
+	// It stays around hidden until then, out of the explosive network and out of reach of bullets
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	if (UExplosiveNetworkSubsystem* ExplosiveNetwork = UExplosiveNetworkSubsystem::Get(this))
+	{
+		ExplosiveNetwork->UnregisterExplosive(this);
 	}
 
-	ExplosiveActor->Destroy();
+	BlastDamage->ApplyBlast(
+		GetBlastCenter(),
+		GetBlastRadius(),
+		Damage,
+		DamageFalloff,
+		OverlappingActors,
+		ShooterController,
+		DamageCauser,
+		this,
+		FSimpleDelegate::CreateUObject(this, &AExplosive::OnBlastApplied)
+	);
 }
 
-void AExplosive::FuseExplosive(FHitResult HitResult, AActor* Shooter, AController* ShooterController, AActor* DamagedActor, AActor* ExplosiveActor, float BlastDelay)
+void AExplosive::OnBlastApplied()
 {
+	Destroy();
+}
 
-	FTimerHandle ExplosionTimer;
-	FTimerDelegate DelayedExplosionDelegate;
-
-	DelayedExplosionDelegate.BindUFunction(
-		ExplosiveActor,
-		FName("DelayedExplosion"),
-		HitResult,
-		Shooter,
-		ShooterController,
-		DamagedActor,
-		ExplosiveActor
-	);
+FVector AExplosive::GetBlastCenter() const
+{
+	return OverlapSphere->GetComponentLocation();
+}
 
-	GetWorld()->GetTimerManager().SetTimer(
-		ExplosionTimer,
-		DelayedExplosionDelegate,
-		FMath::FRandRange(0.2f, 1.f),
-		false
-	);
+float AExplosive::GetBlastRadius() const
+{
+	return OverlapSphere->GetScaledSphereRadius();
 }
 
+float AExplosive::GetBoundsRadius() const
+{
+	return ExplosiveMesh->Bounds.SphereRadius;
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "BulletHitInterface.h"
+#include "BlastDamageSubsystem.h"
 #include "Explosive.generated.h"
 
 UCLASS()
@@ -19,13 +20,13 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
-	
-	UFUNCTION()
-	void DelayedExplosion(FHitResult HitResult, AActor* Shooter, AController* ShooterController, AActor* DamagedActor, AActor* ExplosiveActor);
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Keeps the explosive network's edges up to date when the explosive is moved or knocked over */
+	void OnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
 
-	UFUNCTION()
-	void FuseExplosive(FHitResult HitResult, AActor* Shooter, AController* ShooterController, AActor* DamagedActor, AActor* ExplosiveActor, float BlastDelay = 1.0f);
+	/** Destroys the explosive once its blast damage is applied */
+	void OnBlastApplied();
 
 private:
 
@@ -47,6 +48,10 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float Damage;
 
+	/** How damage falls off towards the edge of OverlapSphere */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FBlastFalloff DamageFalloff;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float ExplosionDelay;
 
@@ -54,6 +59,17 @@ private:
 	float ChainExplosionDelay;
 
 public:	
-	// Called every frame
 	virtual void BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, AController* ShooterController) override;
+
+	/** Blast effects, damage to every character in the blast sphere once, then destroys the explosive once the damage is applied */
+	void Explode(const FVector& BlastLocation, AController* ShooterController, AActor* DamageCauser);
+
+	FVector GetBlastCenter() const;
+	float GetBlastRadius() const;
+
+	/** Radius other blasts have to reach to set this one off */
+	float GetBoundsRadius() const;
+
+	FORCEINLINE float GetExplosionDelay() const { return ExplosionDelay; }
+	FORCEINLINE float GetChainExplosionDelay() const { return ChainExplosionDelay; }
 };
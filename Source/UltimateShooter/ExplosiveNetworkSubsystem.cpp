@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ExplosiveNetworkSubsystem.h"
+#include "Explosive.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Explosive Chain Walk"), STAT_ExplosiveChainWalk, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosive Blasts"), STAT_ExplosiveBlasts, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<float> CVarExplosiveRelinkDistance(
+	TEXT("us.Explosives.RelinkDistance"),
+	25.f,
+	TEXT("How far an explosive has to move before its chain edges are rebuilt"));
+
+void UExplosiveNetworkSubsystem::RegisterExplosive(AExplosive* Explosive)
+{
+	if (!Explosive || NodeIndices.Contains(Explosive)) return;
+
+	const int32 NodeIndex{ FreeNodes.Num() > 0 ? FreeNodes.Pop(false) : Nodes.AddDefaulted() };
+	FExplosiveNode& Node = Nodes[NodeIndex];
+	Node = FExplosiveNode();
+	Node.Explosive = Explosive;
+	NodeIndices.Add(Explosive, NodeIndex);
+
+	LinkNode(NodeIndex);
+}
+
+void UExplosiveNetworkSubsystem::UnregisterExplosive(AExplosive* Explosive)
+{
+	int32 NodeIndex;
+	if (!NodeIndices.RemoveAndCopyValue(Explosive, NodeIndex)) return;
+
+	UnlinkNode(NodeIndex);
+	Nodes[NodeIndex] = FExplosiveNode();
+	FreeNodes.Add(NodeIndex);
+}
+
+void UExplosiveNetworkSubsystem::UpdateExplosive(AExplosive* Explosive)
+{
+	const int32* NodeIndex = NodeIndices.Find(Explosive);
+	if (!NodeIndex) return;
+
+	const float RelinkDistance{ CVarExplosiveRelinkDistance.GetValueOnGameThread() };
+	if (FVector::DistSquared(Nodes[*NodeIndex].Center, Explosive->GetBlastCenter()) < FMath::Square(RelinkDistance)) return;
+
+	UnlinkNode(*NodeIndex);
+	LinkNode(*NodeIndex);
+}
+
+void UExplosiveNetworkSubsystem::Detonate(AExplosive* Source, const FVector& BlastLocation, AActor* Shooter, AController* ShooterController)
+{
+	if (!Source) return;
+
+	if (const int32* NodeIndex = NodeIndices.Find(Source))
+	{
+		QueueChain(*NodeIndex, ShooterController);
+	}
+
+	INC_DWORD_STAT(STAT_ExplosiveBlasts);
+	Source->Explode(BlastLocation, ShooterController, Shooter);
+}
+
+UExplosiveNetworkSubsystem* UExplosiveNetworkSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UExplosiveNetworkSubsystem>() : nullptr;
+}
+
+void UExplosiveNetworkSubsystem::DumpStats() const
+{
+	int32 NumEdges{ 0 };
+	int32 MaxNeighbors{ 0 };
+	for (const FExplosiveNode& Node : Nodes)
+	{
+		NumEdges += Node.Neighbors.Num();
+		MaxNeighbors = FMath::Max(MaxNeighbors, Node.Neighbors.Num());
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Explosives: %d in the network, %d chain edges (max %d from one explosive), %d blasts queued"),
+		NodeIndices.Num(),
+		NumEdges,
+		MaxNeighbors,
+		DetonationQueue.Num());
+}
+
+void UExplosiveNetworkSubsystem::LinkNode(int32 NodeIndex)
+{
+	FExplosiveNode& Node = Nodes[NodeIndex];
+	const AExplosive* Explosive = Node.Explosive.Get();
+	if (!Explosive) return;
+
+	Node.Center = Explosive->GetBlastCenter();
+	Node.BlastRadius = Explosive->GetBlastRadius();
+	Node.BoundsRadius = Explosive->GetBoundsRadius();
+
+	for (int32 OtherIndex = 0; OtherIndex < Nodes.Num(); ++OtherIndex)
+	{
+		FExplosiveNode& Other = Nodes[OtherIndex];
+		if (OtherIndex == NodeIndex || !Other.Explosive.IsValid()) continue;
+
+		const float DistanceSquared{ FVector::DistSquared(Node.Center, Other.Center) };
+		if (DistanceSquared <= FMath::Square(Node.BlastRadius + Other.BoundsRadius))
+		{
+			Node.Neighbors.Add(OtherIndex);
+			Other.Reachers.Add(NodeIndex);
+		}
+		if (DistanceSquared <= FMath::Square(Other.BlastRadius + Node.BoundsRadius))
+		{
+			Other.Neighbors.Add(NodeIndex);
+			Node.Reachers.Add(OtherIndex);
+		}
+	}
+}
+
+void UExplosiveNetworkSubsystem::UnlinkNode(int32 NodeIndex)
+{
+	FExplosiveNode& Node = Nodes[NodeIndex];
+	for (int32 NeighborIndex : Node.Neighbors)
+	{
+		Nodes[NeighborIndex].Reachers.RemoveSingleSwap(NodeIndex, false);
+	}
+	for (int32 ReacherIndex : Node.Reachers)
+	{
+		Nodes[ReacherIndex].Neighbors.RemoveSingleSwap(NodeIndex, false);
+	}
+	Node.Neighbors.Reset();
+	Node.Reachers.Reset();
+}
+
+void UExplosiveNetworkSubsystem::QueueChain(int32 SourceIndex, AController* ShooterController)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExplosiveChainWalk);
+
+	const AExplosive* Source = Nodes[SourceIndex].Explosive.Get();
+	if (!Source) return;
+
+	// The source goes off now, so it is marked but never queued
+	Nodes[SourceIndex].bQueued = true;
+
+	// Blasts follow each other ChainExplosionDelay apart in the order the walk reaches them
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	float BlastTime{ Now + Source->GetExplosionDelay() };
+
+	TArray<int32, TInlineAllocator<32>> Frontier;
+	Frontier.Add(SourceIndex);
+	for (int32 FrontierIndex = 0; FrontierIndex < Frontier.Num(); ++FrontierIndex)
+	{
+		for (int32 NeighborIndex : Nodes[Frontier[FrontierIndex]].Neighbors)
+		{
+			FExplosiveNode& Neighbor = Nodes[NeighborIndex];
+			if (Neighbor.bQueued || !Neighbor.Explosive.IsValid()) continue;
+
+			Neighbor.bQueued = true;
+			Frontier.Add(NeighborIndex);
+
+			FQueuedDetonation Detonation;
+			Detonation.Explosive = Neighbor.Explosive;
+			Detonation.ShooterController = ShooterController;
+			Detonation.Time = BlastTime;
+
+			// Insert sorted, later chains can interleave with earlier ones
+			const int32 InsertIndex{ Algo::UpperBoundBy(DetonationQueue, BlastTime, &FQueuedDetonation::Time) };
+			DetonationQueue.Insert(Detonation, InsertIndex);
+
+			BlastTime += Source->GetChainExplosionDelay();
+		}
+	}
+
+	ScheduleDrain();
+}
+
+void UExplosiveNetworkSubsystem::DrainQueue()
+{
+	const float Now{ GetWorld()->GetTimeSeconds() };
+
+	int32 NumDue{ 0 };
+	while (NumDue < DetonationQueue.Num() && DetonationQueue[NumDue].Time <= Now)
+	{
+		++NumDue;
+	}
+
+	// Blasts unregister their explosive, so the due ones come off the queue before any goes off
+	TArray<FQueuedDetonation, TInlineAllocator<16>> Due(DetonationQueue.GetData(), NumDue);
+	DetonationQueue.RemoveAt(0, NumDue, false);
+
+	for (const FQueuedDetonation& Detonation : Due)
+	{
+		AExplosive* Explosive = Detonation.Explosive.Get();
+		if (!Explosive) continue;
+
+		INC_DWORD_STAT(STAT_ExplosiveBlasts);
+		Explosive->Explode(Explosive->GetActorLocation(), Detonation.ShooterController.Get(), Explosive);
+	}
+
+	ScheduleDrain();
+}
+
+void UExplosiveNetworkSubsystem::ScheduleDrain()
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (DetonationQueue.Num() == 0)
+	{
+		TimerManager.ClearTimer(DetonationTimer);
+		return;
+	}
+
+	const float Delay{ DetonationQueue[0].Time - GetWorld()->GetTimeSeconds() };
+	TimerManager.SetTimer(
+		DetonationTimer,
+		FTimerDelegate::CreateUObject(this, &UExplosiveNetworkSubsystem::DrainQueue),
+		FMath::Max(Delay, KINDA_SMALL_NUMBER),
+		false
+	);
+}
+
+static FAutoConsoleCommandWithWorld ExplosivesStatsCommand(
+	TEXT("us.Explosives.Stats"),
+	TEXT("Logs the explosive network: explosives, chain edges and queued blasts"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UExplosiveNetworkSubsystem* ExplosiveNetwork = UExplosiveNetworkSubsystem::Get(World))
+		{
+			ExplosiveNetwork->DumpStats();
+		}
+	})
+);
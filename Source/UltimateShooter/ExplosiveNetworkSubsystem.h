@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ExplosiveNetworkSubsystem.generated.h"
+
+class AExplosive;
+
+/** An explosive in the network and the explosives its blast reaches */
+struct FExplosiveNode
+{
+	TWeakObjectPtr<AExplosive> Explosive;
+
+	/** Blast sphere, and the bounds other blasts have to reach */
+	FVector Center = FVector::ZeroVector;
+	float BlastRadius = 0.f;
+	float BoundsRadius = 0.f;
+
+	/** Nodes inside this blast, and nodes whose blast reaches this one */
+	TArray<int32> Neighbors;
+	TArray<int32> Reachers;
+
+	/** Already in the detonation queue, a second chain doesn't post it again */
+	bool bQueued = false;
+};
+
+/** A chained blast waiting in the detonation queue */
+struct FQueuedDetonation
+{
+	TWeakObjectPtr<AExplosive> Explosive;
+
+	/** Chained blasts are caused by their explosive, damage is still instigated by the shooter */
+	TWeakObjectPtr<AController> ShooterController;
+
+	/** World time the blast goes off */
+	float Time = 0.f;
+};
+
+/**
+ * Chain explosions through a precomputed graph instead of overlap queries at detonation.
+ * Explosives register at BeginPlay, and an edge goes from each explosive to every explosive its blast sphere reaches.
+ * Edges are updated when an explosive moves or is destroyed. A detonation walks the graph once, breadth first,
+ * and posts every explosive the chain reaches to one detonation queue ordered by time, drained by a single timer.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UExplosiveNetworkSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	void RegisterExplosive(AExplosive* Explosive);
+	void UnregisterExplosive(AExplosive* Explosive);
+
+	/** Rebuilds the explosive's edges if it moved far enough to change them */
+	void UpdateExplosive(AExplosive* Explosive);
+
+	/** Sets off the explosive now and queues every explosive its chain reaches */
+	void Detonate(AExplosive* Source, const FVector& BlastLocation, AActor* Shooter, AController* ShooterController);
+
+	static UExplosiveNetworkSubsystem* Get(const UObject* WorldContextObject);
+
+	void DumpStats() const;
+
+private:
+
+	/** Edges from and to the node, against every other node */
+	void LinkNode(int32 NodeIndex);
+	void UnlinkNode(int32 NodeIndex);
+
+	/** Walks the chain from the source and posts what it reaches to the queue */
+	void QueueChain(int32 SourceIndex, AController* ShooterController);
+
+	/** Detonates every queued blast that is due and sets the timer for the next one */
+	void DrainQueue();
+
+	void ScheduleDrain();
+
+	/** Sparse, freed nodes are reused */
+	TArray<FExplosiveNode> Nodes;
+	TArray<int32> FreeNodes;
+	TMap<TWeakObjectPtr<AExplosive>, int32> NodeIndices;
+
+	/** Ordered by time, earliest first */
+	TArray<FQueuedDetonation> DetonationQueue;
+
+	FTimerHandle DetonationTimer;
+};
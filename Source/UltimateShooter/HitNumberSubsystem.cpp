@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitNumberSubsystem.h"
+#include "Blueprint/UserWidget.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "SceneView.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Hit Numbers"), STAT_UpdateHitNumbers, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Hit Numbers"), STAT_LiveHitNumbers, STATGROUP_UltimateShooter);
+
+void UHitNumberSubsystem::Deinitialize()
+{
+	for (const FLiveHitNumber& HitNumber : LiveHitNumbers)
+	{
+		if (IsValid(HitNumber.Widget)) HitNumber.Widget->RemoveFromParent();
+	}
+	for (UUserWidget* Widget : PooledWidgets)
+	{
+		if (IsValid(Widget)) Widget->RemoveFromParent();
+	}
+	LiveHitNumbers.Empty();
+	FreeWidgets.Empty();
+	PooledWidgets.Empty();
+
+	Super::Deinitialize();
+}
+
+void UHitNumberSubsystem::InitializePool(APlayerController* OwningPlayer, TSubclassOf<UUserWidget> WidgetClass, int32 PoolSize)
+{
+	if (!OwningPlayer || !WidgetClass) return;
+
+	for (int32 Index = PooledWidgets.Num(); Index < PoolSize; ++Index)
+	{
+		UUserWidget* Widget = CreateWidget<UUserWidget>(OwningPlayer, WidgetClass);
+		if (!Widget) break;
+
+		Widget->AddToViewport();
+		Widget->SetVisibility(ESlateVisibility::Collapsed);
+		PooledWidgets.Add(Widget);
+		FreeWidgets.Add(Widget);
+	}
+}
+
+UUserWidget* UHitNumberSubsystem::AcquireWidget()
+{
+	UUserWidget* Widget = nullptr;
+
+	while (!Widget && FreeWidgets.Num() > 0)
+	{
+		Widget = FreeWidgets.Pop(false);
+		if (!IsValid(Widget)) Widget = nullptr;
+	}
+
+	if (!Widget)
+	{
+		// Pool is empty: reuse the oldest pooled number on screen
+		const int32 OldestIndex = LiveHitNumbers.IndexOfByPredicate([](const FLiveHitNumber& HitNumber) { return HitNumber.bPooled; });
+		if (OldestIndex == INDEX_NONE) return nullptr;
+
+		Widget = LiveHitNumbers[OldestIndex].Widget;
+		LiveHitNumbers.RemoveAt(OldestIndex, 1, false);
+	}
+
+	Widget->SetVisibility(ESlateVisibility::HitTestInvisible);
+	return Widget;
+}
+
+void UHitNumberSubsystem::AddHitNumber(UUserWidget* Widget, const FVector& Location, float Lifetime)
+{
+	if (!Widget) return;
+
+	FLiveHitNumber HitNumber;
+	HitNumber.Widget = Widget;
+	HitNumber.Location = Location;
+	HitNumber.ExpireTime = GetWorld()->GetTimeSeconds() + Lifetime;
+	HitNumber.bPooled = PooledWidgets.Contains(Widget);
+	LiveHitNumbers.Add(HitNumber);
+}
+
+UHitNumberSubsystem* UHitNumberSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UHitNumberSubsystem>() : nullptr;
+}
+
+void UHitNumberSubsystem::Tick(float DeltaTime)
+{
+	UpdateHitNumbers();
+}
+
+ETickableTickType UHitNumberSubsystem::GetTickableTickType() const
+{
+	// The class default object never ticks
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UHitNumberSubsystem::IsTickable() const
+{
+	return LiveHitNumbers.Num() > 0;
+}
+
+TStatId UHitNumberSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHitNumberSubsystem, STATGROUP_Tickables);
+}
+
+void UHitNumberSubsystem::UpdateHitNumbers()
+{
+	SCOPE_CYCLE_COUNTER(STAT_UpdateHitNumbers);
+
+	// Expire in world time, so numbers last longer in bullet time like the timers they replace
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	for (const FLiveHitNumber& HitNumber : LiveHitNumbers)
+	{
+		if (HitNumber.ExpireTime <= Now) ReleaseHitNumber(HitNumber);
+	}
+	LiveHitNumbers.RemoveAll([Now](const FLiveHitNumber& HitNumber) { return HitNumber.ExpireTime <= Now || !IsValid(HitNumber.Widget); });
+
+	SET_DWORD_STAT(STAT_LiveHitNumbers, LiveHitNumbers.Num());
+
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (!LocalPlayer || !LocalPlayer->ViewportClient) return;
+
+	// Build the view projection once for every number
+	FSceneViewProjectionData ProjectionData;
+	if (!LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, eSSP_FULL, ProjectionData)) return;
+
+	const FMatrix ViewProjectionMatrix{ ProjectionData.ComputeViewProjectionMatrix() };
+	const FIntRect ViewRect{ ProjectionData.GetConstrainedViewRect() };
+
+	for (const FLiveHitNumber& HitNumber : LiveHitNumbers)
+	{
+		FVector2D ScreenPosition;
+		if (FSceneView::ProjectWorldToScreen(HitNumber.Location, ViewRect, ViewProjectionMatrix, ScreenPosition))
+		{
+			HitNumber.Widget->SetPositionInViewport(ScreenPosition);
+		}
+	}
+}
+
+void UHitNumberSubsystem::ReleaseHitNumber(const FLiveHitNumber& HitNumber)
+{
+	if (!IsValid(HitNumber.Widget)) return;
+
+	if (HitNumber.bPooled)
+	{
+		HitNumber.Widget->SetVisibility(ESlateVisibility::Collapsed);
+		FreeWidgets.Add(HitNumber.Widget);
+	}
+	else
+	{
+		HitNumber.Widget->RemoveFromParent();
+	}
+}
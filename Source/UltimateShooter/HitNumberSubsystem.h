@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "HitNumberSubsystem.generated.h"
+
+class UUserWidget;
+class APlayerController;
+
+/** A hit number on screen and the world location it follows */
+USTRUCT()
+struct FLiveHitNumber
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UUserWidget* Widget = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+
+	/** World time the number is removed at */
+	float ExpireTime = 0.f;
+
+	/** Widget goes back to the pool instead of being removed from the viewport */
+	bool bPooled = false;
+};
+
+/**
+ * Owns every hit number on screen.
+ * Keeps a fixed pool of hit number widgets, expires numbers from one list instead of a timer per hit,
+ * and projects all live numbers to the screen in a single pass per frame.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UHitNumberSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** Creates the pooled widgets, collapsed in the viewport of the player */
+	void InitializePool(APlayerController* OwningPlayer, TSubclassOf<UUserWidget> WidgetClass, int32 PoolSize);
+
+	/** Gets a pooled widget, stealing the oldest live one when the pool is empty. Null if no pool was set up */
+	UUserWidget* AcquireWidget();
+
+	/** Shows a hit number at a world location for Lifetime seconds */
+	void AddHitNumber(UUserWidget* Widget, const FVector& Location, float Lifetime);
+
+	static UHitNumberSubsystem* Get(const UObject* WorldContextObject);
+
+	FORCEINLINE int32 GetNumLiveHitNumbers() const { return LiveHitNumbers.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	/** Removes expired numbers and moves the rest to their screen positions */
+	void UpdateHitNumbers();
+
+	void ReleaseHitNumber(const FLiveHitNumber& HitNumber);
+
+	/** Oldest first */
+	UPROPERTY()
+	TArray<FLiveHitNumber> LiveHitNumbers;
+
+	UPROPERTY()
+	TArray<UUserWidget*> FreeWidgets;
+
+	/** Every widget created for the pool */
+	UPROPERTY()
+	TArray<UUserWidget*> PooledWidgets;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitZone.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+
+void FHitZoneLookup::Build(const USkeletalMeshComponent* Mesh, const UDataTable* HitZoneTable, FName FallbackHeadBone)
+{
+	ZoneByBoneIndex.Reset();
+
+	if (!Mesh || !Mesh->SkeletalMesh) return;
+
+	const FReferenceSkeleton& RefSkeleton = Mesh->SkeletalMesh->GetRefSkeleton();
+	const int32 NumBones{ RefSkeleton.GetNum() };
+
+	// Zones listed explicitly, by bone index
+	TMap<int32, FHitZoneInfo> ListedZones;
+
+	if (HitZoneTable && HitZoneTable->GetRowStruct() == FHitZoneTable::StaticStruct())
+	{
+		HitZoneTable->ForeachRow<FHitZoneTable>(TEXT("FHitZoneLookup::Build"), [&](const FName& BoneName, const FHitZoneTable& Row)
+		{
+			const int32 BoneIndex{ RefSkeleton.FindBoneIndex(BoneName) };
+			if (BoneIndex != INDEX_NONE)
+			{
+				FHitZoneInfo& Info = ListedZones.Add(BoneIndex);
+				Info.Zone = Row.Zone;
+				Info.DamageMultiplier = Row.DamageMultiplier;
+			}
+		});
+	}
+	else if (!FallbackHeadBone.IsNone())
+	{
+		const int32 HeadBoneIndex{ RefSkeleton.FindBoneIndex(FallbackHeadBone) };
+		if (HeadBoneIndex != INDEX_NONE)
+		{
+			ListedZones.Add(HeadBoneIndex).Zone = EHitZone::EHZ_Head;
+		}
+	}
+
+	// Parents always come before their children in the reference skeleton
+	ZoneByBoneIndex.SetNum(NumBones);
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		if (const FHitZoneInfo* Listed = ListedZones.Find(BoneIndex))
+		{
+			ZoneByBoneIndex[BoneIndex] = *Listed;
+			continue;
+		}
+
+		const int32 ParentIndex{ RefSkeleton.GetParentIndex(BoneIndex) };
+		if (ParentIndex != INDEX_NONE)
+		{
+			ZoneByBoneIndex[BoneIndex] = ZoneByBoneIndex[ParentIndex];
+		}
+	}
+}
+
+FHitZoneInfo FHitZoneLookup::Find(const USkeletalMeshComponent* Mesh, FName BoneName) const
+{
+	if (!Mesh || BoneName.IsNone()) return FHitZoneInfo();
+
+	const int32 BoneIndex{ Mesh->GetBoneIndex(BoneName) };
+	return ZoneByBoneIndex.IsValidIndex(BoneIndex) ? ZoneByBoneIndex[BoneIndex] : FHitZoneInfo();
+}
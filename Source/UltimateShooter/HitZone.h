@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "HitZone.generated.h"
+
+UENUM(BlueprintType)
+enum class EHitZone : uint8
+{
+	EHZ_Torso UMETA(DisplayName = "Torso"),
+	EHZ_Head UMETA(DisplayName = "Head"),
+	EHZ_Limb UMETA(DisplayName = "Limb"),
+	EHZ_WeakPoint UMETA(DisplayName = "WeakPoint"),
+
+	EHZ_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/** Row name is the bone the zone starts at. Child bones inherit the zone of their closest listed parent */
+USTRUCT(BlueprintType)
+struct FHitZoneTable : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EHitZone Zone = EHitZone::EHZ_Torso;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float DamageMultiplier = 1.f;
+};
+
+/** Zone and multiplier of a single bone */
+struct FHitZoneInfo
+{
+	EHitZone Zone = EHitZone::EHZ_Torso;
+
+	float DamageMultiplier = 1.f;
+
+	/** Heads and weak points take headshot damage and can crit into executions */
+	FORCEINLINE bool IsHeadshot() const { return Zone == EHitZone::EHZ_Head || Zone == EHitZone::EHZ_WeakPoint; }
+};
+
+/**
+ * Hit zone of every bone of a skeletal mesh, built once from a hit zone table.
+ * Looking a hit up is a bone index lookup, no string work.
+ */
+struct FHitZoneLookup
+{
+public:
+
+	/**
+	* Walks the reference skeleton and gives every bone the zone of its closest listed parent.
+	* @param Mesh Mesh whose skeleton the lookup is built for
+	* @param HitZoneTable Table of FHitZoneTable rows. May be null
+	* @param FallbackHeadBone Used as the only head zone when there is no table
+	*/
+	void Build(const USkeletalMeshComponent* Mesh, const UDataTable* HitZoneTable, FName FallbackHeadBone);
+
+	/** Zone of the bone a hit result reports, torso for unknown bones */
+	FHitZoneInfo Find(const USkeletalMeshComponent* Mesh, FName BoneName) const;
+
+private:
+
+	TArray<FHitZoneInfo> ZoneByBoneIndex;
+};
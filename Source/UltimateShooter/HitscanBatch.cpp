@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitscanBatch.h"
+#include "Engine/World.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitscan Batch Trace"), STAT_HitscanBatchTrace, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Batch Rays"), STAT_HitscanBatchRays, STATGROUP_UltimateShooter);
+
+FHitscanBatch::FHitscanBatch(int32 ExpectedRays)
+{
+	RayStarts.Reserve(ExpectedRays);
+	RayEnds.Reserve(ExpectedRays);
+	RayHits.Reserve(ExpectedRays);
+}
+
+void FHitscanBatch::AddRay(const FVector& Start, const FVector& End)
+{
+	RayStarts.Add(Start);
+	RayEnds.Add(End);
+}
+
+void FHitscanBatch::Trace(UWorld* World, const FCollisionQueryParams& QueryParams)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitscanBatchTrace);
+	INC_DWORD_STAT_BY(STAT_HitscanBatchRays, RayStarts.Num());
+
+	RayHits.Reset();
+	ActorHits.Reset();
+
+	if (!World) return;
+
+	for (int32 RayIndex = 0; RayIndex < RayStarts.Num(); ++RayIndex)
+	{
+		FHitResult& Hit = RayHits.AddDefaulted_GetRef();
+
+		World->LineTraceSingleByChannel(
+			Hit,
+			RayStarts[RayIndex],
+			RayEnds[RayIndex],
+			ECollisionChannel::ECC_Visibility,
+			QueryParams
+		);
+
+		if (!Hit.bBlockingHit)
+		{
+			Hit.Location = RayEnds[RayIndex];
+			continue;
+		}
+
+		if (AActor* HitActor = Hit.GetActor())
+		{
+			ActorHits.FindOrAdd(HitActor).Add(RayIndex);
+		}
+	}
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Collects every ray of a multi-pellet shot, traces them together and merges the hits per actor,
+ * so a shotgun blast costs one damage, hit number and BulletHit call per actor instead of one per pellet.
+ */
+struct FHitscanBatch
+{
+public:
+
+	FHitscanBatch(int32 ExpectedRays = 0);
+
+	/** Adds a ray to be traced with the rest of the batch */
+	void AddRay(const FVector& Start, const FVector& End);
+
+	/** Traces every ray on the visibility channel with one shared set of query params, then groups the hits by actor */
+	void Trace(UWorld* World, const FCollisionQueryParams& QueryParams);
+
+	/** One result per ray, in the order the rays were added. Misses have their Location set to the ray end */
+	FORCEINLINE const TArray<FHitResult>& GetRayHits() const { return RayHits; }
+
+	/** Indices into GetRayHits() for each actor that was hit at least once */
+	FORCEINLINE const TMap<AActor*, TArray<int32>>& GetActorHits() const { return ActorHits; }
+
+	FORCEINLINE int32 Num() const { return RayStarts.Num(); }
+
+private:
+
+	TArray<FVector> RayStarts;
+
+	TArray<FVector> RayEnds;
+
+	TArray<FHitResult> RayHits;
+
+	TMap<AActor*, TArray<int32>> ActorHits;
+};
@@ -0,0 +1,446 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HordeSubsystem.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "EnemyPoolSubsystem.h"
+#include "NavigationSystem.h"
+#include "Async/ParallelFor.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Horde Simulate"), STAT_HordeSimulate, STATGROUP_UltimateShooter);
+DECLARE_CYCLE_STAT(TEXT("Horde Promote / Demote"), STAT_HordePromoteDemote, STATGROUP_UltimateShooter);
+DECLARE_CYCLE_STAT(TEXT("Horde Update Instances"), STAT_HordeUpdateInstances, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Horde Members"), STAT_HordeMembers, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Horde Promotions"), STAT_HordePromotions, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Horde Demotions"), STAT_HordeDemotions, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<float> CVarHordePromoteDistance(
+	TEXT("us.Horde.PromoteDistance"),
+	3000.f,
+	TEXT("Horde members closer than this to the player become enemy actors"));
+
+static TAutoConsoleVariable<float> CVarHordeDemoteDistance(
+	TEXT("us.Horde.DemoteDistance"),
+	5000.f,
+	TEXT("Promoted enemies out of combat beyond this distance from the player go back to the horde"));
+
+static TAutoConsoleVariable<float> CVarHordeAdvanceDistance(
+	TEXT("us.Horde.AdvanceDistance"),
+	8000.f,
+	TEXT("Horde members within this distance of the player walk towards them, the others wander"));
+
+static TAutoConsoleVariable<int32> CVarHordeMaxPromotionsPerFrame(
+	TEXT("us.Horde.MaxPromotionsPerFrame"),
+	4,
+	TEXT("Max horde members promoted plus enemies demoted per frame"));
+
+namespace Horde
+{
+	/** Below this many members the simulation runs on the game thread */
+	static constexpr int32 MinParallelMembers{ 256 };
+
+	/** Degrees per second wandering members turn at most */
+	static constexpr float WanderTurnRate{ 90.f };
+
+	/** Fraction of their walk speed members wander at */
+	static constexpr float WanderSpeedFactor{ 0.5f };
+
+	static constexpr float VelocityInterpSpeed{ 2.f };
+}
+
+int32 FHordeMembers::Add(const FVector& Position, const FVector& Velocity, float InHealth, EHordeState State, uint8 Archetype)
+{
+	Positions.Add(Position);
+	Velocities.Add(Velocity);
+	Health.Add(InHealth);
+	States.Add(State);
+	Archetypes.Add(Archetype);
+	return PlayerDistancesSquared.Add(TNumericLimits<float>::Max());
+}
+
+void FHordeMembers::RemoveAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	Health.RemoveAtSwap(Index, 1, false);
+	States.RemoveAtSwap(Index, 1, false);
+	Archetypes.RemoveAtSwap(Index, 1, false);
+	PlayerDistancesSquared.RemoveAtSwap(Index, 1, false);
+}
+
+void FHordeMembers::Reset()
+{
+	Positions.Reset();
+	Velocities.Reset();
+	Health.Reset();
+	States.Reset();
+	Archetypes.Reset();
+	PlayerDistancesSquared.Reset();
+}
+
+void UHordeSubsystem::Deinitialize()
+{
+	Members.Reset();
+	PromotedEnemies.Reset();
+	Archetypes.Reset();
+	InstancesActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UHordeSubsystem::AddMember(TSubclassOf<AEnemy> EnemyClass, const FVector& Position, const FVector& Velocity)
+{
+	const int32 Archetype{ FindOrAddArchetype(EnemyClass) };
+	if (Archetype == INDEX_NONE) return false;
+
+	Members.Add(Position, Velocity, Archetypes[Archetype].MaxHealth, EHordeState::Wander, (uint8)Archetype);
+	return true;
+}
+
+void UHordeSubsystem::DemoteEnemy(AEnemy* Enemy)
+{
+	if (!IsValid(Enemy) || Enemy->IsDying()) return;
+
+	const int32 Archetype{ FindOrAddArchetype(Enemy->GetClass()) };
+	if (Archetype == INDEX_NONE) return;
+
+	const bool bAdvancing{ Enemy->GetEnemyController() && Enemy->GetEnemyController()->GetEnemyBlackboard().GetTargetActor() != nullptr };
+	Members.Add(
+		Enemy->GetActorLocation(),
+		Enemy->GetVelocity(),
+		Enemy->GetHealth(),
+		bAdvancing ? EHordeState::Advance : EHordeState::Wander,
+		(uint8)Archetype);
+
+	INC_DWORD_STAT(STAT_HordeDemotions);
+	PromotedEnemies.RemoveSingleSwap(Enemy, false);
+
+	UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(this);
+	if (!EnemyPool || !EnemyPool->Release(Enemy))
+	{
+		Enemy->Destroy();
+	}
+}
+
+void UHordeSubsystem::ClearMembers()
+{
+	Members.Reset();
+	UpdateInstances();
+}
+
+UHordeSubsystem* UHordeSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UHordeSubsystem>() : nullptr;
+}
+
+void UHordeSubsystem::Tick(float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_HordeMembers, Members.Num());
+
+	APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!Player) return;
+
+	SimulationTime += DeltaTime;
+	Simulate(DeltaTime, Player->GetActorLocation());
+	PromoteAndDemote(Player);
+	UpdateInstances();
+}
+
+ETickableTickType UHordeSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UHordeSubsystem::IsTickable() const
+{
+	return Members.Num() > 0 || PromotedEnemies.Num() > 0;
+}
+
+TStatId UHordeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHordeSubsystem, STATGROUP_Tickables);
+}
+
+int32 UHordeSubsystem::FindOrAddArchetype(TSubclassOf<AEnemy> EnemyClass)
+{
+	if (!EnemyClass) return INDEX_NONE;
+
+	const int32 Existing{ Archetypes.IndexOfByPredicate([EnemyClass](const FHordeArchetype& Archetype) { return Archetype.EnemyClass == EnemyClass; }) };
+	if (Existing != INDEX_NONE) return Existing;
+
+	// Members store their archetype in a byte
+	if (Archetypes.Num() > MAX_uint8) return INDEX_NONE;
+
+	const AEnemy* DefaultEnemy = EnemyClass->GetDefaultObject<AEnemy>();
+
+	FHordeArchetype& Archetype = Archetypes.AddDefaulted_GetRef();
+	Archetype.EnemyClass = EnemyClass;
+	Archetype.MaxHealth = DefaultEnemy->GetMaxHealth();
+	Archetype.WalkSpeed = DefaultEnemy->GetCharacterMovement()->MaxWalkSpeed;
+	Archetype.CapsuleHalfHeight = DefaultEnemy->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	// Nothing to draw without a proxy mesh, or on a server
+	if (DefaultEnemy->GetHordeProxyMesh() && !IsRunningDedicatedServer())
+	{
+		if (!InstancesActor)
+		{
+			InstancesActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+		}
+
+		UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(InstancesActor);
+		Instances->SetStaticMesh(DefaultEnemy->GetHordeProxyMesh());
+		Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Instances->SetCastShadow(false);
+		Instances->SetMobility(EComponentMobility::Movable);
+		if (!InstancesActor->GetRootComponent())
+		{
+			InstancesActor->SetRootComponent(Instances);
+		}
+		else
+		{
+			Instances->SetupAttachment(InstancesActor->GetRootComponent());
+		}
+		Instances->RegisterComponent();
+		InstancesActor->AddInstanceComponent(Instances);
+
+		Archetype.Instances = Instances;
+	}
+
+	return Archetypes.Num() - 1;
+}
+
+void UHordeSubsystem::Simulate(float DeltaTime, const FVector& PlayerLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HordeSimulate);
+
+	const float AdvanceDistanceSquared{ FMath::Square(CVarHordeAdvanceDistance.GetValueOnGameThread()) };
+	const float Time{ SimulationTime };
+
+	ParallelFor(Members.Num(), [this, DeltaTime, Time, &PlayerLocation, AdvanceDistanceSquared](int32 Index)
+	{
+		FVector& Position = Members.Positions[Index];
+		FVector& Velocity = Members.Velocities[Index];
+		const float WalkSpeed{ Archetypes[Members.Archetypes[Index]].WalkSpeed };
+
+		FVector ToPlayer{ PlayerLocation - Position };
+		ToPlayer.Z = 0.f;
+		const float DistanceSquared{ ToPlayer.SizeSquared() };
+		Members.PlayerDistancesSquared[Index] = DistanceSquared;
+
+		FVector DesiredVelocity;
+		if (DistanceSquared < AdvanceDistanceSquared)
+		{
+			Members.States[Index] = EHordeState::Advance;
+			DesiredVelocity = ToPlayer.GetSafeNormal() * WalkSpeed;
+		}
+		else
+		{
+			// Each member sways left and right at its own phase
+			Members.States[Index] = EHordeState::Wander;
+			const FVector Heading{ Velocity.IsNearlyZero() ? FVector(FMath::Cos((float)Index), FMath::Sin((float)Index), 0.f) : Velocity.GetSafeNormal2D() };
+			const float Turn{ FMath::Sin(Time * 0.5f + Index * 1.3f) * Horde::WanderTurnRate * DeltaTime };
+			DesiredVelocity = Heading.RotateAngleAxis(Turn, FVector::UpVector) * WalkSpeed * Horde::WanderSpeedFactor;
+		}
+
+		Velocity = FMath::VInterpTo(Velocity, DesiredVelocity, DeltaTime, Horde::VelocityInterpSpeed);
+		Position += Velocity * DeltaTime;
+	}, Members.Num() < Horde::MinParallelMembers ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UHordeSubsystem::PromoteAndDemote(APawn* Player)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HordePromoteDemote);
+
+	int32 Budget{ CVarHordeMaxPromotionsPerFrame.GetValueOnGameThread() };
+	const FVector PlayerLocation{ Player->GetActorLocation() };
+
+	// Closest members first
+	const float PromoteDistanceSquared{ FMath::Square(CVarHordePromoteDistance.GetValueOnGameThread()) };
+	TArray<int32, TInlineAllocator<16>> Candidates;
+	for (int32 Index = 0; Index < Members.Num(); ++Index)
+	{
+		if (Members.PlayerDistancesSquared[Index] < PromoteDistanceSquared)
+		{
+			Candidates.Add(Index);
+		}
+	}
+	Candidates.Sort([this](int32 A, int32 B) { return Members.PlayerDistancesSquared[A] < Members.PlayerDistancesSquared[B]; });
+	Candidates.SetNum(FMath::Min(Candidates.Num(), FMath::Max(Budget, 0)), false);
+
+	// Highest index first, so removing one doesn't move the others
+	Candidates.Sort([](int32 A, int32 B) { return A > B; });
+	for (int32 Index : Candidates)
+	{
+		if (Promote(Index, Player)) --Budget;
+	}
+
+	const float DemoteDistanceSquared{ FMath::Square(CVarHordeDemoteDistance.GetValueOnGameThread()) };
+	for (int32 Index = PromotedEnemies.Num() - 1; Index >= 0; --Index)
+	{
+		AEnemy* Enemy = PromotedEnemies[Index].Get();
+		if (!Enemy || Enemy->IsDying())
+		{
+			PromotedEnemies.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (Budget > 0 && !Enemy->IsInCombat() && FVector::DistSquared2D(Enemy->GetActorLocation(), PlayerLocation) > DemoteDistanceSquared)
+		{
+			DemoteEnemy(Enemy);
+			--Budget;
+		}
+	}
+}
+
+bool UHordeSubsystem::Promote(int32 MemberIndex, APawn* Player)
+{
+	UEnemyPoolSubsystem* EnemyPool = UEnemyPoolSubsystem::Get(this);
+	if (!EnemyPool) return false;
+
+	const FHordeArchetype& Archetype = Archetypes[Members.Archetypes[MemberIndex]];
+	const FVector Velocity{ Members.Velocities[MemberIndex] };
+	const FRotator Rotation{ Velocity.IsNearlyZero() ? FRotator::ZeroRotator : FRotator(0.f, Velocity.Rotation().Yaw, 0.f) };
+
+	// Members only move in XY, the member is retried next frame when there's no ground under it
+	FVector Location;
+	if (!FindPromoteLocation(Members.Positions[MemberIndex], Archetype, Location)) return false;
+
+	AEnemy* Enemy = EnemyPool->Acquire(Archetype.EnemyClass, FTransform(Rotation, Location));
+	if (!Enemy) return false;
+
+	INC_DWORD_STAT(STAT_HordePromotions);
+
+	Enemy->SetHealth(Members.Health[MemberIndex]);
+	Enemy->GetCharacterMovement()->Velocity = Velocity;
+	if (Members.States[MemberIndex] == EHordeState::Advance && Enemy->GetEnemyController())
+	{
+		Enemy->GetEnemyController()->GetEnemyBlackboard().SetTargetActor(Player);
+	}
+
+	PromotedEnemies.Add(Enemy);
+	Members.RemoveAtSwap(MemberIndex);
+	return true;
+}
+
+bool UHordeSubsystem::FindPromoteLocation(const FVector& Position, const FHordeArchetype& Archetype, FVector& OutLocation) const
+{
+	UWorld* World = GetWorld();
+	const FVector CapsuleOffset{ 0.f, 0.f, Archetype.CapsuleHalfHeight };
+
+	// Slopes and stairs the member walked over flat put the ground up to a capsule height above or below
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (NavSys && NavSys->GetDefaultNavDataInstance())
+	{
+		FNavLocation NavLocation;
+		const FVector Extent{ Archetype.CapsuleHalfHeight, Archetype.CapsuleHalfHeight, Archetype.CapsuleHalfHeight * 2.f };
+		if (!NavSys->ProjectPointToNavigation(Position - CapsuleOffset, NavLocation, Extent)) return false;
+
+		OutLocation = NavLocation.Location + CapsuleOffset;
+		return true;
+	}
+
+	// No navmesh to snap to, stand the enemy on whatever is below
+	FHitResult Hit;
+	const FVector Start{ Position + CapsuleOffset * 2.f };
+	const FVector End{ Position - CapsuleOffset * 3.f };
+	if (!World->LineTraceSingleByChannel(Hit, Start, End, ECollisionChannel::ECC_Visibility)) return false;
+
+	OutLocation = Hit.ImpactPoint + CapsuleOffset;
+	return true;
+}
+
+void UHordeSubsystem::UpdateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_HordeUpdateInstances);
+
+	TArray<TArray<FTransform>, TInlineAllocator<4>> Transforms;
+	Transforms.SetNum(Archetypes.Num());
+
+	for (int32 Index = 0; Index < Members.Num(); ++Index)
+	{
+		const uint8 Archetype{ Members.Archetypes[Index] };
+		if (!Archetypes[Archetype].Instances) continue;
+
+		const FVector& Velocity = Members.Velocities[Index];
+		const FRotator Rotation{ 0.f, Velocity.IsNearlyZero() ? 0.f : Velocity.Rotation().Yaw, 0.f };
+		const FVector Location{ Members.Positions[Index] - FVector(0.f, 0.f, Archetypes[Archetype].CapsuleHalfHeight) };
+		Transforms[Archetype].Emplace(Rotation, Location);
+	}
+
+	for (int32 Archetype = 0; Archetype < Archetypes.Num(); ++Archetype)
+	{
+		UInstancedStaticMeshComponent* Instances = Archetypes[Archetype].Instances;
+		if (!Instances) continue;
+
+		// The instance count only changes with promotions and demotions, other frames move the instances in place
+		if (Instances->GetInstanceCount() != Transforms[Archetype].Num())
+		{
+			Instances->ClearInstances();
+			Instances->AddInstances(Transforms[Archetype], false);
+		}
+		else if (Transforms[Archetype].Num() > 0)
+		{
+			Instances->BatchUpdateInstancesTransforms(0, Transforms[Archetype], true, true, true);
+		}
+	}
+}
+
+/** Adds N horde members of an enemy class in a ring around the player, for stress testing with stat UltimateShooter */
+static void HordeStress(const TArray<FString>& Args, UWorld* World)
+{
+	UHordeSubsystem* Horde = World ? World->GetSubsystem<UHordeSubsystem>() : nullptr;
+	if (!Horde) return;
+
+	const int32 NumMembers{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000 };
+	UClass* EnemyClass = LoadClass<AEnemy>(nullptr, Args.Num() > 1 ? *Args[1] : TEXT("/Game/_Game/Enemies/Grux/BP_EnemyGrux.BP_EnemyGrux_C"));
+	if (!EnemyClass || NumMembers <= 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Horde: usage us.Horde.Stress [Count] [EnemyClassPath]"));
+		return;
+	}
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+	const FVector Center{ Player ? Player->GetActorLocation() : FVector::ZeroVector };
+
+	// Outside promotion range, so the run starts with every member in the horde
+	const float MinRadius{ CVarHordePromoteDistance.GetValueOnGameThread() * 1.5f };
+	const float MaxRadius{ FMath::Max(MinRadius * 2.f, 20000.f) };
+
+	FRandomStream Random(1337);
+	for (int32 Index = 0; Index < NumMembers; ++Index)
+	{
+		const float Angle{ Random.FRandRange(0.f, 2.f * PI) };
+		const float Radius{ FMath::Sqrt(Random.FRandRange(FMath::Square(MinRadius), FMath::Square(MaxRadius))) };
+		Horde->AddMember(EnemyClass, Center + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.f));
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Horde: %d members, %d promoted"), Horde->GetNumMembers(), Horde->GetNumPromoted());
+}
+
+static FAutoConsoleCommandWithWorldAndArgs HordeStressCommand(
+	TEXT("us.Horde.Stress"),
+	TEXT("Adds N horde members (default 5000) of an enemy class around the player"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&HordeStress)
+);
+
+static FAutoConsoleCommandWithWorld HordeClearCommand(
+	TEXT("us.Horde.Clear"),
+	TEXT("Removes every horde member, promoted enemies stay"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UHordeSubsystem* Horde = World ? World->GetSubsystem<UHordeSubsystem>() : nullptr)
+		{
+			Horde->ClearMembers();
+		}
+	})
+);
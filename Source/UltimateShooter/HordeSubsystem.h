@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "HordeSubsystem.generated.h"
+
+class AEnemy;
+class UInstancedStaticMeshComponent;
+
+/** What a horde member is doing */
+enum class EHordeState : uint8
+{
+	Wander,
+	Advance
+};
+
+/** Enemy class a horde member promotes to, and how its members are drawn */
+USTRUCT()
+struct FHordeArchetype
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AEnemy> EnemyClass;
+
+	/** Instances of the enemy's HordeProxyMesh, null when it has none */
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Instances = nullptr;
+
+	float MaxHealth = 100.f;
+	float WalkSpeed = 300.f;
+
+	/** Members are simulated at capsule center height, proxy meshes stand on the ground */
+	float CapsuleHalfHeight = 0.f;
+};
+
+/** Horde members as struct of arrays, one entry per member in each array */
+struct FHordeMembers
+{
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> Health;
+	TArray<EHordeState> States;
+	TArray<uint8> Archetypes;
+
+	/** Horizontal distance to the nearest player, written by the simulation */
+	TArray<float> PlayerDistancesSquared;
+
+	FORCEINLINE int32 Num() const { return Positions.Num(); }
+
+	int32 Add(const FVector& Position, const FVector& Velocity, float InHealth, EHordeState State, uint8 Archetype);
+	void RemoveAtSwap(int32 Index);
+	void Reset();
+};
+
+/**
+ * Far-away enemies as plain data instead of actors. Members are simulated in parallel, drawn as instances
+ * of their enemy's HordeProxyMesh, and promoted to full AEnemy actors from the enemy pool when they get
+ * within us.Horde.PromoteDistance of the player. Promoted enemies out of combat beyond us.Horde.DemoteDistance
+ * are demoted back. Health, velocity and whether they were advancing on the player carry over both ways.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UHordeSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** Adds a horde member of the enemy class, returns false if the class can't be used */
+	bool AddMember(TSubclassOf<AEnemy> EnemyClass, const FVector& Position, const FVector& Velocity = FVector::ZeroVector);
+
+	/** Turns the enemy back into a horde member and returns it to the enemy pool */
+	void DemoteEnemy(AEnemy* Enemy);
+
+	void ClearMembers();
+
+	FORCEINLINE int32 GetNumMembers() const { return Members.Num(); }
+	FORCEINLINE int32 GetNumPromoted() const { return PromotedEnemies.Num(); }
+
+	static UHordeSubsystem* Get(const UObject* WorldContextObject);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	int32 FindOrAddArchetype(TSubclassOf<AEnemy> EnemyClass);
+
+	/** Moves every member, in parallel */
+	void Simulate(float DeltaTime, const FVector& PlayerLocation);
+
+	/** Promotes the closest members in range, demotes promoted enemies out of range, within the per frame budget */
+	void PromoteAndDemote(APawn* Player);
+
+	/** Turns the member into an enemy from the enemy pool, false when there is no ground under it or no enemy could be spawned */
+	bool Promote(int32 MemberIndex, APawn* Player);
+
+	/** Where the member's enemy spawns, its position snapped to the navmesh or the ground. False when neither is there */
+	bool FindPromoteLocation(const FVector& Position, const FHordeArchetype& Archetype, FVector& OutLocation) const;
+
+	void UpdateInstances();
+
+	UPROPERTY()
+	TArray<FHordeArchetype> Archetypes;
+
+	/** Owns the instanced mesh components */
+	UPROPERTY()
+	AActor* InstancesActor = nullptr;
+
+	FHordeMembers Members;
+
+	/** Enemies promoted from the horde, candidates for demotion */
+	TArray<TWeakObjectPtr<AEnemy>> PromotedEnemies;
+
+	/** Drives wandering members' turns */
+	float SimulationTime = 0.f;
+};
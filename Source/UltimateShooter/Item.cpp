@@ -11,6 +11,14 @@
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 #include "Curves/CurveVector.h"
+#include "CombatAudioSubsystem.h"
+#include "ItemDataRegistry.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+// Time driven glow params, the material pulses the glow params by the curve it samples from Pulse Start Time
+static const FName PulseEnabledParam{ TEXT("Pulse Enabled") };
+static const FName PulseStartTimeParam{ TEXT("Pulse Start Time") };
+static const FName PulsePeriodParam{ TEXT("Pulse Period") };
 
 // Sets default values
 AItem::AItem() :
@@ -35,12 +43,17 @@ AItem::AItem() :
 	FresnelExponent(3.f),
 	FresnelReflectFraction(4.f),
 	PulseCurveTime(5.f),
+	PulseStartTime(0.f),
+	bMaterialDrivesPulse(false),
+	bImplementsReceiveTick(false),
 	//Inventory
 	SlotIndex(0),
 	bCharacterInventoryFull(false)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+	// Only interping and the pulse fallback tick, see UpdateTickEnabled
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
 	SetRootComponent(ItemMesh);
@@ -61,6 +74,8 @@ AItem::AItem() :
 void AItem::BeginPlay()
 {
 	Super::BeginPlay();
+
+	bImplementsReceiveTick = GetClass()->IsFunctionImplementedInScript(FName("ReceiveTick"));
 	
 	// Hide Widget at start
 	if (PickupWidget)
@@ -81,8 +96,8 @@ void AItem::BeginPlay()
 	// Initialize Custom Depth to false
 	InitializeCustomDepth();
 
-	// Start the Curve Pulse Timer for Dynamic materials If in PICKUP state
-	StartPulseTimer();
+	// Start the Curve Pulse for Dynamic materials If in PICKUP state
+	RefreshMaterialEffects();
 }
 
 /** Callback function for AreaSphere BeginComponentOverlap */
@@ -100,6 +115,7 @@ void AItem::OnSphereOverlap(
 		if (Shooter)
 		{
 			Shooter->IncrememtOverlappedItemCount(1);
+			PrefetchInventoryAssets();
 		}
 	}
 }
@@ -273,6 +289,9 @@ void AItem::FinishItemInterping()
 {
 	bIsInterping = false;
 
+	// The equip sound and the inventory icons are needed from here on
+	LoadInventoryAssets();
+
 	if (ShooterCharacter)
 	{
 		ShooterCharacter->IncrementInterpLocItemCount(InterpLocIndex, -1); // Substract from the interplocaions for this index
@@ -288,6 +307,7 @@ void AItem::FinishItemInterping()
 	bCanChangeCustomDepth = true; // This needs to be done before DisableCustomDepth();
 	DisableCustomDepth();
 
+	UpdateTickEnabled();
 }
 
 void AItem::ItemInterp(float DeltaTime)
@@ -367,7 +387,7 @@ void AItem::PlayPickupSound(bool bForcePlaySound)
 		{
 			if (PickupSound)
 			{
-				UGameplayStatics::PlaySound2D(this, PickupSound);
+				UCombatAudioSubsystem::PlaySound2D(this, PickupSound, ECombatAudioCategory::ECAC_Pickup);
 			}
 		}
 		else if (ShooterCharacter->ShouldPlayPickupSound())
@@ -375,7 +395,7 @@ void AItem::PlayPickupSound(bool bForcePlaySound)
 			ShooterCharacter->StartPickupSoundTimer();
 			if (PickupSound)
 			{
-				UGameplayStatics::PlaySound2D(this, PickupSound);
+				UCombatAudioSubsystem::PlaySound2D(this, PickupSound, ECombatAudioCategory::ECAC_Pickup);
 			}
 		}
 	}
@@ -405,50 +425,18 @@ void AItem::InitializeCustomDepth()
 // Called when Item is changed or moved in the world
 void AItem::OnConstruction(const FTransform& Transform)
 {
-	// Load the data in the Item Rarity Data Table
-	
-	// Path to the Item Rarity Data Table
-	FString RarityTablePath(TEXT("DataTable'/Game/_Game/DataTables/DT_ItemRarity.DT_ItemRarity'"));
-	UDataTable* RarityTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *RarityTablePath)); // * needed in front of RarityTable Path since its C Style String
-
-	if (RarityTableObject)
+	// Rarity data comes from the preloaded Item Rarity Data Table
+	if (const FItemRarityTable* RarityRow = UItemDataRegistry::Get(this)->GetRarityRow(ItemRarity))
 	{
-		FItemRarityTable* RarityRow = nullptr;
-		switch (ItemRarity)
-		{
-		case EItemRarity::EWR_Damaged:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Damaged"), TEXT(""));
-			break;
-
-		case EItemRarity::EWR_Common:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Common"), TEXT(""));
-			break;
-
-		case EItemRarity::EWR_Uncommon:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Uncommon"), TEXT(""));
-			break;
-
-		case EItemRarity::EWR_Rare:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Rare"), TEXT(""));
-			break;
-
-		case EItemRarity::EWR_Legendary:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Legendary"), TEXT(""));
-			break;
-		}
+		GlowColor = RarityRow->GlowColor;
+		LightColor = RarityRow->LightColor;
+		DarkColor = RarityRow->DarkColor;
+		NumberOfStars = RarityRow->NumberOfStars;
+		IconBackground = RarityRow->IconBackground;
 
-		if (RarityRow)
+		if (GetItemMesh())
 		{
-			GlowColor = RarityRow->GlowColor;
-			LightColor = RarityRow->LightColor;
-			DarkColor = RarityRow->DarkColor;
-			NumberOfStars = RarityRow->NumberOfStars;
-			IconBackground = RarityRow->IconBackground;
-
-			if (GetItemMesh())
-			{
-				GetItemMesh()->SetCustomDepthStencilValue(RarityRow->CustomDepthStencil);
-			}
+			GetItemMesh()->SetCustomDepthStencilValue(RarityRow->CustomDepthStencil);
 		}
 	}
 
@@ -478,9 +466,9 @@ void AItem::UpdatePulse()
 	switch (ItemState)
 	{
 	case EItemState::EIS_Pickup:
-		if (PulseCurve)
+		if (PulseCurve && PulseCurveTime > 0.f)
 		{
-			ElapsedTime = GetWorldTimerManager().GetTimerElapsed(PulseTimer);
+			ElapsedTime = FMath::Fmod(GetWorld()->GetTimeSeconds() - PulseStartTime, PulseCurveTime);
 			CurveValue = PulseCurve->GetVectorValue(ElapsedTime);
 		}
 		break;
@@ -523,7 +511,7 @@ void AItem::PlayEquipSound(bool bForcePlaySound)
 		{
 			if (EquipSound)
 			{
-				UGameplayStatics::PlaySound2D(this, EquipSound);
+				UCombatAudioSubsystem::PlaySound2D(this, EquipSound, ECombatAudioCategory::ECAC_Pickup);
 			}
 		}
 		else if (ShooterCharacter->ShouldPlayEquipSound())
@@ -531,7 +519,7 @@ void AItem::PlayEquipSound(bool bForcePlaySound)
 			ShooterCharacter->StartEquipSoundTimer();
 			if (EquipSound)
 			{
-				UGameplayStatics::PlaySound2D(this, EquipSound);
+				UCombatAudioSubsystem::PlaySound2D(this, EquipSound, ECombatAudioCategory::ECAC_Pickup);
 			}
 		}
 	}
@@ -546,23 +534,76 @@ void AItem::Tick(float DeltaTime)
 	ItemInterp(DeltaTime);
 
 	// Get Values from pulse curve and set Dynamic material properties for Glow
-	UpdatePulse();
+	if (bIsInterping || (ItemState == EItemState::EIS_Pickup && !bMaterialDrivesPulse))
+	{
+		UpdatePulse();
+	}
 }
 
-void AItem::ResetPulseTimer()
+void AItem::RefreshPulse()
 {
-	StartPulseTimer();
+	if (ItemState == EItemState::EIS_Pickup)
+	{
+		StartPulse();
+	}
+	else
+	{
+		StopPulse();
+	}
 }
 
-void AItem::StartPulseTimer()
+void AItem::StartPulse()
 {
-	/** Note that this function is calling iteself
-	* If in PICKUP State, it will keep running the timer
-	*/
-	if (ItemState == EItemState::EIS_Pickup)
+	PulseStartTime = GetWorld()->GetTimeSeconds();
+
+	if (!bMaterialDrivesPulse || !DynamicMaterialInstance) return;
+
+	// Set once, the material scales these by the pulse curve every frame on its own
+	DynamicMaterialInstance->SetScalarParameterValue(PulseEnabledParam, 1.f);
+	DynamicMaterialInstance->SetScalarParameterValue(PulseStartTimeParam, PulseStartTime);
+	DynamicMaterialInstance->SetScalarParameterValue(PulsePeriodParam, PulseCurveTime);
+	DynamicMaterialInstance->SetScalarParameterValue(TEXT("Glow Amount"), GlowAmount);
+	DynamicMaterialInstance->SetScalarParameterValue(TEXT("Fresnel Exponent"), FresnelExponent);
+	DynamicMaterialInstance->SetScalarParameterValue(TEXT("Fresnel Reflect Fraction"), FresnelReflectFraction);
+}
+
+void AItem::StopPulse()
+{
+	if (!DynamicMaterialInstance) return;
+
+	if (bMaterialDrivesPulse)
 	{
-		GetWorldTimerManager().SetTimer(PulseTimer, this, &AItem::ResetPulseTimer, PulseCurveTime);
+		DynamicMaterialInstance->SetScalarParameterValue(PulseEnabledParam, 0.f);
 	}
+
+	// Out of the Pickup state the glow params are zero until the interp pulse drives them
+	DynamicMaterialInstance->SetScalarParameterValue(TEXT("Glow Amount"), 0.f);
+	DynamicMaterialInstance->SetScalarParameterValue(TEXT("Fresnel Exponent"), 0.f);
+	DynamicMaterialInstance->SetScalarParameterValue(TEXT("Fresnel Reflect Fraction"), 0.f);
+}
+
+bool AItem::MaterialHasParameter(FName ParameterName) const
+{
+	float Value;
+	return DynamicMaterialInstance && DynamicMaterialInstance->GetScalarParameterValue(FMaterialParameterInfo(ParameterName), Value);
+}
+
+void AItem::RefreshMaterialEffects()
+{
+	bMaterialDrivesPulse = MaterialHasParameter(PulseStartTimeParam);
+	RefreshPulse();
+	UpdateTickEnabled();
+}
+
+bool AItem::NeedsTick() const
+{
+	const bool bNeedsPulseTick{ ItemState == EItemState::EIS_Pickup && !bMaterialDrivesPulse && PulseCurve && DynamicMaterialInstance };
+	return bImplementsReceiveTick || bIsInterping || bNeedsPulseTick;
+}
+
+void AItem::UpdateTickEnabled()
+{
+	SetActorTickEnabled(NeedsTick());
 }
 
 void AItem::SetItemState(EItemState State)
@@ -571,6 +612,9 @@ void AItem::SetItemState(EItemState State)
 	ItemState = State;
 	// Update Item properties depending on Current State
 	SetItemProperties(State);
+
+	RefreshPulse();
+	UpdateTickEnabled();
 }
 
 void AItem::StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound)
@@ -585,12 +629,14 @@ void AItem::StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound)
 	// Play Pickup Sound
 	PlayPickupSound(bForcePlaySound);
 
+	// In case the player got here without overlapping the item first
+	PrefetchInventoryAssets();
+
 	// Store initial location of the item
 	ItemInterpStartLocation = GetActorLocation();
 	bIsInterping = true;
 
-	SetItemState(EItemState::EIS_EquipInterping); // Note: Dont forget to update collision properties
-	GetWorldTimerManager().ClearTimer(PulseTimer); // Clear Pulse Timer as soon as Interp Starts
+	SetItemState(EItemState::EIS_EquipInterping); // Note: Dont forget to update collision properties. Stops the pickup pulse
 
 	GetWorldTimerManager().SetTimer(
 		ItemInterpTimer,
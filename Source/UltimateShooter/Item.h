@@ -121,10 +121,32 @@ protected:
 
 	void EnableGlowMaterial();
 
-	void ResetPulseTimer();
-	void StartPulseTimer();
+	/** Starts the pickup pulse in Pickup state, clears the glow params in any other state */
+	void RefreshPulse();
+	void StartPulse();
+	void StopPulse();
+
+	/** Sets the glow params from the pulse curves, only needed while interping or when the material can't pulse itself */
 	void UpdatePulse();
 
+	/** True when the material has the named parameter, used to check for time driven effects */
+	bool MaterialHasParameter(FName ParameterName) const;
+
+	/** Checks which effects the material drives itself, again whenever the dynamic material is replaced */
+	virtual void RefreshMaterialEffects();
+
+	/**
+	 * Prefetch starts streaming the assets the item needs once picked up, when the player comes near it,
+	 * and Load loads them if they haven't streamed in yet. Items reference their assets directly so both do nothing here,
+	 * weapons stream theirs.
+	 */
+	virtual void PrefetchInventoryAssets() {}
+	virtual void LoadInventoryAssets() {}
+
+	/** Items only tick while something moves them, see UpdateTickEnabled */
+	virtual bool NeedsTick() const;
+	void UpdateTickEnabled();
+
 	EItemRarity GetItemRarity();
 
 public:	
@@ -244,12 +266,19 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	UCurveVector* InterpPulseCurve; // For Glow Flash Effect when Interping
 
-	FTimerHandle PulseTimer;
-
-	/** Time for the Pulse Timer */
+	/** Length of one pickup pulse, the pulse curve repeats every PulseCurveTime */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float PulseCurveTime;
 
+	/** World time the pickup pulse started, the pulse repeats every PulseCurveTime from here */
+	float PulseStartTime;
+
+	/** The material animates the pickup pulse from Pulse Start Time with its Time node, so the item doesn't have to tick for it */
+	bool bMaterialDrivesPulse;
+
+	/** Blueprint Event Tick needs the actor to tick all the time */
+	bool bImplementsReceiveTick;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float GlowAmount;
 
@@ -0,0 +1,431 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemDataRegistry.h"
+#include "Weapon.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/PackageName.h"
+#include "UltimateShooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Table Lookups By Path"), STAT_ItemTableLookupsByPath, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Asset Sync Loads"), STAT_WeaponAssetSyncLoads, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<int32> CVarItemFlatTables(
+	TEXT("us.Items.FlatTables"),
+	1,
+	TEXT("1: item data rows come from the preloaded registry, 0: each lookup loads the table by path and finds the row by name"));
+
+static const TCHAR* RarityTablePath{ TEXT("DataTable'/Game/_Game/DataTables/DT_ItemRarity.DT_ItemRarity'") };
+static const TCHAR* WeaponTablePath{ TEXT("DataTable'/Game/_Game/DataTables/DT_Weapon.DT_Weapon'") };
+static const TCHAR* RarityBonusTablePath{ TEXT("DataTable'/Game/_Game/DataTables/DT_RarityBonusProps.DT_RarityBonusProps'") };
+
+// Row names in enum order
+static const FName RarityRowNames[]{ FName("Damaged"), FName("Common"), FName("Uncommon"), FName("Rare"), FName("Legendary") };
+static const FName WeaponRowNames[]{ FName("SubmachineGun"), FName("AssaultRifle"), FName("Pistol"), FName("Shotgun") };
+
+static_assert(UE_ARRAY_COUNT(RarityRowNames) == static_cast<int32>(EItemRarity::EWR_MAX), "A row name for each item rarity");
+static_assert(UE_ARRAY_COUNT(WeaponRowNames) == static_cast<int32>(EWeaponType::EWT_MAX), "A row name for each weapon type");
+
+static UDataTable* LoadTable(const TCHAR* TablePath, const UScriptStruct* RowStruct)
+{
+	UDataTable* Table = LoadObject<UDataTable>(nullptr, TablePath);
+	if (!Table)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ItemDataRegistry: %s not found"), TablePath);
+		return nullptr;
+	}
+	if (!Table->GetRowStruct() || !Table->GetRowStruct()->IsChildOf(RowStruct))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ItemDataRegistry: %s rows are not %s"), *Table->GetName(), *RowStruct->GetName());
+		return nullptr;
+	}
+	return Table;
+}
+
+template<typename RowType, int32 NumRows>
+static void FlattenRows(const UDataTable* Table, const FName (&RowNames)[NumRows], TArray<const RowType*>& OutRows)
+{
+	OutRows.Init(nullptr, NumRows);
+	if (!Table) return;
+
+	for (int32 Index = 0; Index < NumRows; ++Index)
+	{
+		OutRows[Index] = Table->FindRow<RowType>(RowNames[Index], TEXT(""), false);
+		if (!OutRows[Index])
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ItemDataRegistry: %s has no %s row"), *Table->GetName(), *RowNames[Index].ToString());
+		}
+	}
+}
+
+static void AddAssetPath(TArray<FSoftObjectPath>& Paths, const FSoftObjectPath& Path)
+{
+	if (!Path.IsNull())
+	{
+		Paths.AddUnique(Path);
+	}
+}
+
+/** The lookup item construction used to do, kept for us.Items.FlatTables 0 */
+template<typename RowType>
+static const RowType* FindRowByPath(const TCHAR* TablePath, FName RowName)
+{
+	INC_DWORD_STAT(STAT_ItemTableLookupsByPath);
+	const UDataTable* Table = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, TablePath));
+	return Table ? Table->FindRow<RowType>(RowName, TEXT("")) : nullptr;
+}
+
+void UItemDataRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LoadTables();
+}
+
+void UItemDataRegistry::Deinitialize()
+{
+	UnloadTables();
+
+	Super::Deinitialize();
+}
+
+UItemDataRegistry* UItemDataRegistry::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (UItemDataRegistry* ItemDataRegistry = GameInstance ? GameInstance->GetSubsystem<UItemDataRegistry>() : nullptr)
+	{
+		return ItemDataRegistry;
+	}
+
+	// Editor worlds have no game instance, the default object loads the tables the first time it is asked
+	UItemDataRegistry* DefaultRegistry = GetMutableDefault<UItemDataRegistry>();
+	if (!DefaultRegistry->bTablesLoaded)
+	{
+		DefaultRegistry->LoadTables();
+	}
+	return DefaultRegistry;
+}
+
+const FItemRarityTable* UItemDataRegistry::GetRarityRow(EItemRarity Rarity) const
+{
+	const int32 Index{ static_cast<int32>(Rarity) };
+	if (!RarityRows.IsValidIndex(Index)) return nullptr;
+
+	if (CVarItemFlatTables.GetValueOnGameThread() == 0)
+	{
+		return FindRowByPath<FItemRarityTable>(RarityTablePath, RarityRowNames[Index]);
+	}
+	return RarityRows[Index];
+}
+
+const FWeaponDataTable* UItemDataRegistry::GetWeaponRow(EWeaponType WeaponType) const
+{
+	const int32 Index{ static_cast<int32>(WeaponType) };
+	if (!WeaponRows.IsValidIndex(Index)) return nullptr;
+
+	if (CVarItemFlatTables.GetValueOnGameThread() == 0)
+	{
+		return FindRowByPath<FWeaponDataTable>(WeaponTablePath, WeaponRowNames[Index]);
+	}
+	return WeaponRows[Index];
+}
+
+const FRarityBasedPropsTable* UItemDataRegistry::GetRarityBonusRow(EItemRarity Rarity) const
+{
+	const int32 Index{ static_cast<int32>(Rarity) };
+	if (!RarityBonusRows.IsValidIndex(Index)) return nullptr;
+
+	if (CVarItemFlatTables.GetValueOnGameThread() == 0)
+	{
+		return FindRowByPath<FRarityBasedPropsTable>(RarityBonusTablePath, RarityRowNames[Index]);
+	}
+	return RarityBonusRows[Index];
+}
+
+bool UItemDataRegistry::AreWeaponAssetsLoaded(EWeaponType WeaponType, EWeaponAssetGroup Group) const
+{
+	TArray<FSoftObjectPath> AssetPaths;
+	GetWeaponAssetPaths(WeaponType, Group, AssetPaths);
+
+	for (const FSoftObjectPath& AssetPath : AssetPaths)
+	{
+		if (!AssetPath.ResolveObject()) return false;
+	}
+	return true;
+}
+
+TSharedPtr<FStreamableHandle> UItemDataRegistry::RequestWeaponAssets(
+	EWeaponType WeaponType,
+	EWeaponAssetGroup Group,
+	FStreamableDelegate OnLoaded,
+	TAsyncLoadPriority Priority)
+{
+	if (AreWeaponAssetsLoaded(WeaponType, Group))
+	{
+		OnLoaded.ExecuteIfBound();
+		return nullptr;
+	}
+
+	TArray<FSoftObjectPath> AssetPaths;
+	GetWeaponAssetPaths(WeaponType, Group, AssetPaths);
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	return StreamableManager.RequestAsyncLoad(
+		MoveTemp(AssetPaths),
+		FStreamableDelegate::CreateWeakLambda(this, [this, StartTime, OnLoaded]()
+		{
+			AsyncLoadSeconds += FPlatformTime::Seconds() - StartTime;
+			++NumAsyncLoads;
+			OnLoaded.ExecuteIfBound();
+		}),
+		Priority
+	);
+}
+
+void UItemDataRegistry::LoadWeaponAssets(EWeaponType WeaponType, EWeaponAssetGroup Group)
+{
+	TArray<FSoftObjectPath> AssetPaths;
+	GetWeaponAssetPaths(WeaponType, Group, AssetPaths);
+
+	for (const FSoftObjectPath& AssetPath : AssetPaths)
+	{
+		if (AssetPath.ResolveObject()) continue;
+
+		const double StartTime{ FPlatformTime::Seconds() };
+		StreamableManager.LoadSynchronous(AssetPath);
+		SyncLoadSeconds += FPlatformTime::Seconds() - StartTime;
+		++NumSyncLoads;
+		INC_DWORD_STAT(STAT_WeaponAssetSyncLoads);
+	}
+}
+
+void UItemDataRegistry::DumpStreamingReport() const
+{
+	int64 TotalResidentBytes{ 0 };
+	int64 TotalNotLoadedBytes{ 0 };
+
+	for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(EWeaponType::EWT_MAX); ++TypeIndex)
+	{
+		FString GroupReport;
+		for (int32 GroupIndex = 0; GroupIndex < static_cast<int32>(EWeaponAssetGroup::MAX); ++GroupIndex)
+		{
+			TArray<FSoftObjectPath> AssetPaths;
+			GetWeaponAssetPaths(static_cast<EWeaponType>(TypeIndex), static_cast<EWeaponAssetGroup>(GroupIndex), AssetPaths);
+
+			int32 NumLoaded{ 0 };
+			int64 ResidentBytes{ 0 };
+			int64 NotLoadedBytes{ 0 };
+			for (const FSoftObjectPath& AssetPath : AssetPaths)
+			{
+				if (UObject* Asset = AssetPath.ResolveObject())
+				{
+					++NumLoaded;
+					ResidentBytes += Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+					continue;
+				}
+
+				// Not loaded, so only the package on disk tells how big it is
+				FString PackageFilename;
+				if (FPackageName::DoesPackageExist(AssetPath.GetLongPackageName(), nullptr, &PackageFilename))
+				{
+					NotLoadedBytes += FMath::Max<int64>(IFileManager::Get().FileSize(*PackageFilename), 0);
+				}
+			}
+
+			GroupReport += FString::Printf(TEXT(", %s %d/%d loaded (%lld KB resident, ~%lld KB on disk not loaded)"),
+				GroupIndex == static_cast<int32>(EWeaponAssetGroup::Display) ? TEXT("display") : TEXT("inventory"),
+				NumLoaded,
+				AssetPaths.Num(),
+				ResidentBytes / 1024,
+				NotLoadedBytes / 1024);
+
+			TotalResidentBytes += ResidentBytes;
+			TotalNotLoadedBytes += NotLoadedBytes;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Weapons: %s%s"), *WeaponRowNames[TypeIndex].ToString(), *GroupReport);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Weapons: %lld KB of weapon assets resident, ~%lld KB left on disk. Tables loaded in %.2f ms"),
+		TotalResidentBytes / 1024,
+		TotalNotLoadedBytes / 1024,
+		TableLoadSeconds * 1000.0);
+	UE_LOG(LogTemp, Display, TEXT("Weapons: %d async loads (%.2f ms to complete in total), %d synchronous loads (%.2f ms on the game thread)"),
+		NumAsyncLoads,
+		AsyncLoadSeconds * 1000.0,
+		NumSyncLoads,
+		SyncLoadSeconds * 1000.0);
+}
+
+void UItemDataRegistry::GetWeaponAssetPaths(EWeaponType WeaponType, EWeaponAssetGroup Group, TArray<FSoftObjectPath>& OutPaths) const
+{
+	const FWeaponDataTable* WeaponDataRow = GetWeaponRow(WeaponType);
+	if (!WeaponDataRow) return;
+
+	switch (Group)
+	{
+	case EWeaponAssetGroup::Display:
+		AddAssetPath(OutPaths, WeaponDataRow->ItemMesh.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->MaterialInstance.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->AnimBP.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->PickupSound.ToSoftObjectPath());
+		break;
+
+	case EWeaponAssetGroup::Inventory:
+		AddAssetPath(OutPaths, WeaponDataRow->EquipSound.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->FireSound.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->MuzzleFlash.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->InventoryIcon.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->AmmoIcon.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->CrosshairsMiddle.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->CrosshairsLeft.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->CrosshairsRight.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->CrosshairsBottom.ToSoftObjectPath());
+		AddAssetPath(OutPaths, WeaponDataRow->CrosshairsTop.ToSoftObjectPath());
+		break;
+	}
+}
+
+void UItemDataRegistry::LoadTables()
+{
+	const double StartTime{ FPlatformTime::Seconds() };
+	RarityTable = LoadTable(RarityTablePath, FItemRarityTable::StaticStruct());
+	WeaponTable = LoadTable(WeaponTablePath, FWeaponDataTable::StaticStruct());
+	RarityBonusTable = LoadTable(RarityBonusTablePath, FRarityBasedPropsTable::StaticStruct());
+	TableLoadSeconds = FPlatformTime::Seconds() - StartTime;
+	bTablesLoaded = true;
+
+#if WITH_EDITOR
+	for (UDataTable* Table : { RarityTable, WeaponTable, RarityBonusTable })
+	{
+		if (Table)
+		{
+			Table->OnDataTableChanged().AddUObject(this, &UItemDataRegistry::FlattenTables);
+		}
+	}
+#endif
+
+	FlattenTables();
+}
+
+void UItemDataRegistry::UnloadTables()
+{
+#if WITH_EDITOR
+	for (UDataTable* Table : { RarityTable, WeaponTable, RarityBonusTable })
+	{
+		if (Table)
+		{
+			Table->OnDataTableChanged().RemoveAll(this);
+		}
+	}
+#endif
+
+	RarityTable = nullptr;
+	WeaponTable = nullptr;
+	RarityBonusTable = nullptr;
+	RarityRows.Reset();
+	WeaponRows.Reset();
+	RarityBonusRows.Reset();
+	bTablesLoaded = false;
+}
+
+void UItemDataRegistry::FlattenTables()
+{
+	FlattenRows(RarityTable, RarityRowNames, RarityRows);
+	FlattenRows(WeaponTable, WeaponRowNames, WeaponRows);
+	FlattenRows(RarityBonusTable, RarityRowNames, RarityBonusRows);
+}
+
+/**
+ * Benchmark: spawns N weapons, which runs their construction, with rows looked up by path and name and with the
+ * flattened registry rows. Reports the spawn time per weapon of each, averaged over the runs.
+ */
+namespace ItemTablesBenchmark
+{
+	static double SpawnWeapons(UWorld* World, int32 NumWeapons, const FVector& Origin)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		TArray<AWeapon*> Weapons;
+		Weapons.Reserve(NumWeapons);
+
+		const int32 RowLength{ FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumWeapons))) };
+		const double StartTime{ FPlatformTime::Seconds() };
+		for (int32 Index = 0; Index < NumWeapons; ++Index)
+		{
+			const FVector Location{ Origin + FVector(Index % RowLength, Index / RowLength, 0.f) * 200.f };
+			Weapons.Add(World->SpawnActor<AWeapon>(AWeapon::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams));
+		}
+		const double SpawnSeconds{ FPlatformTime::Seconds() - StartTime };
+
+		for (AWeapon* Weapon : Weapons)
+		{
+			if (Weapon) Weapon->Destroy();
+		}
+		return SpawnSeconds;
+	}
+
+	static void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World) return;
+
+		const int32 NumWeapons{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 500 };
+		const int32 NumRuns{ Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 5 };
+		if (NumWeapons <= 0 || NumRuns <= 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ItemTables: usage us.Bench.ItemTables [Weapons] [Runs]"));
+			return;
+		}
+
+		// Well away from the player, so the pickups don't overlap them
+		const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+		const FVector Origin{ (Player ? Player->GetActorLocation() : FVector::ZeroVector) - FVector(0.f, 0.f, 50000.f) };
+
+		// Both loaded before timing, only the lookups differ
+		UItemDataRegistry::Get(World);
+		const int32 OriginalFlatTables{ CVarItemFlatTables.GetValueOnGameThread() };
+
+		double ByPathSeconds{ 0.0 };
+		double FlatSeconds{ 0.0 };
+		for (int32 RunIndex = 0; RunIndex < NumRuns; ++RunIndex)
+		{
+			CVarItemFlatTables->Set(0, ECVF_SetByConsole);
+			ByPathSeconds += SpawnWeapons(World, NumWeapons, Origin);
+
+			CVarItemFlatTables->Set(1, ECVF_SetByConsole);
+			FlatSeconds += SpawnWeapons(World, NumWeapons, Origin);
+		}
+		CVarItemFlatTables->Set(OriginalFlatTables, ECVF_SetByConsole);
+
+		const double NumSpawned{ static_cast<double>(NumWeapons) * NumRuns };
+		UE_LOG(LogTemp, Display, TEXT("ItemTables: %d weapons x %d runs, by path %.2f us/weapon, flat tables %.2f us/weapon (%.2f ms saved per %d weapons)"),
+			NumWeapons,
+			NumRuns,
+			ByPathSeconds * 1000000.0 / NumSpawned,
+			FlatSeconds * 1000000.0 / NumSpawned,
+			(ByPathSeconds - FlatSeconds) * 1000.0 / NumRuns,
+			NumWeapons);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ItemTablesBenchmarkCommand(
+	TEXT("us.Bench.ItemTables"),
+	TEXT("Times spawning weapons (default 500, 5 runs) with item data rows looked up by path and from the flattened registry"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ItemTablesBenchmark::Start)
+);
+
+static FAutoConsoleCommandWithWorld WeaponsStreamingReportCommand(
+	TEXT("us.Weapons.StreamingReport"),
+	TEXT("Logs which weapon assets are resident, their memory, what is left on disk and the time spent loading them"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UItemDataRegistry::Get(World)->DumpStreamingReport();
+	})
+);
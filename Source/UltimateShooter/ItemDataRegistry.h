@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "Item.h"
+#include "WeaponType.h"
+#include "ItemDataRegistry.generated.h"
+
+struct FWeaponDataTable;
+struct FRarityBasedPropsTable;
+
+/** The weapon assets streamed in together */
+enum class EWeaponAssetGroup : uint8
+{
+	/** Mesh, material, anim class and pickup sound, needed as soon as the weapon is in the world */
+	Display,
+	/** Sounds, muzzle flash, crosshairs and icons, needed once the weapon is picked up */
+	Inventory,
+
+	MAX
+};
+
+/**
+ * The item rarity, weapon and rarity bonus tables, loaded once and flattened into arrays indexed by
+ * EItemRarity and EWeaponType, so item construction doesn't load the tables by path and find rows by name.
+ * Outside a game instance, for actors constructed in the editor, the class default object stands in.
+ * us.Items.FlatTables 0 looks rows up the old way for comparison.
+ *
+ * The weapon rows reference their assets softly. Weapons stream their display assets in when they are spawned,
+ * and prefetch their inventory assets when the player comes near them. us.Weapons.StreamingReport logs what is resident.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UItemDataRegistry : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Never null, the class default object when the world has no game instance */
+	static UItemDataRegistry* Get(const UObject* WorldContextObject);
+
+	/** Null when the table is missing the row */
+	const FItemRarityTable* GetRarityRow(EItemRarity Rarity) const;
+	const FWeaponDataTable* GetWeaponRow(EWeaponType WeaponType) const;
+	const FRarityBasedPropsTable* GetRarityBonusRow(EItemRarity Rarity) const;
+
+	bool AreWeaponAssetsLoaded(EWeaponType WeaponType, EWeaponAssetGroup Group) const;
+
+	/** Streams the assets in, OnLoaded runs right away when they are already loaded and no handle is returned */
+	TSharedPtr<FStreamableHandle> RequestWeaponAssets(
+		EWeaponType WeaponType,
+		EWeaponAssetGroup Group,
+		FStreamableDelegate OnLoaded,
+		TAsyncLoadPriority Priority = FStreamableManager::DefaultAsyncLoadPriority);
+
+	/** Loads whatever isn't loaded yet on the game thread, for when a weapon needs its assets now */
+	void LoadWeaponAssets(EWeaponType WeaponType, EWeaponAssetGroup Group);
+
+	void DumpStreamingReport() const;
+
+private:
+
+	void GetWeaponAssetPaths(EWeaponType WeaponType, EWeaponAssetGroup Group, TArray<FSoftObjectPath>& OutPaths) const;
+
+	void LoadTables();
+	void UnloadTables();
+
+	/** Rebuilt when a table is edited, the rows point into the tables */
+	void FlattenTables();
+
+	UPROPERTY()
+	UDataTable* RarityTable;
+
+	UPROPERTY()
+	UDataTable* WeaponTable;
+
+	UPROPERTY()
+	UDataTable* RarityBonusTable;
+
+	TArray<const FItemRarityTable*> RarityRows;
+	TArray<const FWeaponDataTable*> WeaponRows;
+	TArray<const FRarityBasedPropsTable*> RarityBonusRows;
+
+	bool bTablesLoaded = false;
+
+	FStreamableManager StreamableManager;
+
+	/** Load times, for the streaming report */
+	double TableLoadSeconds = 0.0;
+	double AsyncLoadSeconds = 0.0;
+	double SyncLoadSeconds = 0.0;
+	int32 NumAsyncLoads = 0;
+	int32 NumSyncLoads = 0;
+};
@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MeleeSweep.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "BrainComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee Sweep"), STAT_MeleeSweep, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Sweep Substeps"), STAT_MeleeSweepSubsteps, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<float> CVarMeleeSweepRadius(
+	TEXT("us.Melee.SweepRadius"),
+	0.f,
+	TEXT("Debug override of the radius of the capsule swept along enemy weapon blades, 0 uses each weapon's own sweep radius"));
+
+static TAutoConsoleVariable<float> CVarMeleeMaxStep(
+	TEXT("us.Melee.MaxStep"),
+	30.f,
+	TEXT("Longest distance the blade moves in one sweep substep"));
+
+static TAutoConsoleVariable<int32> CVarMeleeMaxSubsteps(
+	TEXT("us.Melee.MaxSubsteps"),
+	8,
+	TEXT("Max substeps of one melee sweep"));
+
+static TAutoConsoleVariable<int32> CVarMeleeDebug(
+	TEXT("us.Melee.Debug"),
+	0,
+	TEXT("1 draws enemy weapon sweeps"));
+
+void FMeleeSweep::Start(const USkeletalMeshComponent* Mesh, FName InBaseSocket, FName InTipSocket, float InRadius)
+{
+	BaseSocket = InBaseSocket;
+	TipSocket = InTipSocket;
+	Radius = InRadius;
+	LastBase = Mesh->GetSocketLocation(BaseSocket);
+	LastTip = Mesh->GetSocketLocation(TipSocket);
+	HitActors.Reset();
+	bActive = true;
+}
+
+void FMeleeSweep::Stop()
+{
+	bActive = false;
+}
+
+void FMeleeSweep::Sweep(const USkeletalMeshComponent* Mesh, const FCollisionQueryParams& Params, TArray<FHitResult>& OutNewHits)
+{
+	if (!bActive) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_MeleeSweep);
+
+	const FVector Base{ Mesh->GetSocketLocation(BaseSocket) };
+	const FVector Tip{ Mesh->GetSocketLocation(TipSocket) };
+
+	const float RadiusOverride{ CVarMeleeSweepRadius.GetValueOnGameThread() };
+	const float SweepRadius{ RadiusOverride > 0.f ? RadiusOverride : Radius };
+	const float Moved{ FMath::Max(FVector::Dist(Base, LastBase), FVector::Dist(Tip, LastTip)) };
+	const int32 NumSubsteps{ FMath::Clamp(FMath::CeilToInt(Moved / FMath::Max(CVarMeleeMaxStep.GetValueOnGameThread(), 1.f)), 1, FMath::Max(CVarMeleeMaxSubsteps.GetValueOnGameThread(), 1)) };
+	const bool bDebug{ CVarMeleeDebug.GetValueOnGameThread() != 0 };
+
+	UWorld* World = Mesh->GetWorld();
+	TArray<FHitResult> Hits;
+
+	// The blade is interpolated between the two poses, each substep sweeps it in the orientation it starts with
+	for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
+	{
+		INC_DWORD_STAT(STAT_MeleeSweepSubsteps);
+
+		const float StartAlpha{ (float)Substep / NumSubsteps };
+		const float EndAlpha{ (float)(Substep + 1) / NumSubsteps };
+		const FVector StartBase{ FMath::Lerp(LastBase, Base, StartAlpha) };
+		const FVector StartTip{ FMath::Lerp(LastTip, Tip, StartAlpha) };
+		const FVector EndCenter{ (FMath::Lerp(LastBase, Base, EndAlpha) + FMath::Lerp(LastTip, Tip, EndAlpha)) * 0.5f };
+
+		const FVector Blade{ StartTip - StartBase };
+		const FVector StartCenter{ (StartBase + StartTip) * 0.5f };
+		const FQuat Rotation{ FRotationMatrix::MakeFromZ(Blade).ToQuat() };
+		const FCollisionShape Capsule{ FCollisionShape::MakeCapsule(SweepRadius, Blade.Size() * 0.5f + SweepRadius) };
+
+		Hits.Reset();
+		World->SweepMultiByObjectType(Hits, StartCenter, EndCenter, Rotation, FCollisionObjectQueryParams(ECollisionChannel::ECC_Pawn), Capsule, Params);
+
+		if (bDebug)
+		{
+			DrawDebugCapsule(World, EndCenter, Capsule.GetCapsuleHalfHeight(), SweepRadius, Rotation, Hits.Num() > 0 ? FColor::Red : FColor::Green, false, 1.f);
+		}
+
+		for (const FHitResult& Hit : Hits)
+		{
+			AActor* HitActor = Hit.GetActor();
+			if (!HitActor || HitActors.Contains(HitActor)) continue;
+
+			HitActors.Add(HitActor);
+			OutNewHits.Add(Hit);
+		}
+	}
+
+	LastBase = Base;
+	LastTip = Tip;
+}
+
+/**
+ * Test harness: the enemy closest to the player is put in front of them with its behavior tree paused,
+ * and plays every section of its attack montage in turn. Hits come from the weapon sweeps the montage
+ * notifies switch on, counted per section. The hits are real, use god to keep the player alive.
+ */
+namespace MeleeReplay
+{
+	/** Distance from the player the enemy attacks from */
+	static constexpr float AttackDistance{ 120.f };
+
+	/** Seconds a section may play before it counts as stuck */
+	static constexpr float SectionTimeout{ 10.f };
+
+	struct FReplay
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		TArray<FName> Swings;
+		int32 NextSwing = 0;
+		int32 HitsBeforeSwing = 0;
+		float SwingTime = 0.f;
+		bool bSwinging = false;
+		TMap<FName, FIntPoint> SwingsAndHitsPerSection;
+		FDelegateHandle TickerHandle;
+	};
+
+	static FReplay Replay;
+
+	static void Finish()
+	{
+		int32 NumSwings{ 0 };
+		int32 NumHits{ 0 };
+		for (const TPair<FName, FIntPoint>& Section : Replay.SwingsAndHitsPerSection)
+		{
+			UE_LOG(LogTemp, Display, TEXT("MeleeReplay: %-12s %3d swings, %3d hits"), *Section.Key.ToString(), Section.Value.X, Section.Value.Y);
+			NumSwings += Section.Value.X;
+			NumHits += Section.Value.Y;
+		}
+		UE_LOG(LogTemp, Display, TEXT("MeleeReplay: %d swings, %d hits"), NumSwings, NumHits);
+
+		AEnemy* Enemy = Replay.Enemy.Get();
+		if (Enemy && Enemy->GetEnemyController() && Enemy->GetEnemyController()->GetBrainComponent())
+		{
+			Enemy->GetEnemyController()->GetBrainComponent()->ResumeLogic(TEXT("MeleeReplay"));
+		}
+		Replay = FReplay();
+	}
+
+	static bool Tick(float DeltaTime)
+	{
+		AEnemy* Enemy = Replay.Enemy.Get();
+		UAnimInstance* AnimInstance = Enemy && !Enemy->IsDying() ? Enemy->GetMesh()->GetAnimInstance() : nullptr;
+		if (!AnimInstance)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("MeleeReplay: enemy went away, aborted"));
+			Finish();
+			return false;
+		}
+
+		UAnimMontage* AttackMontage = Enemy->GetAttackMontage();
+		if (Replay.bSwinging)
+		{
+			Replay.SwingTime += DeltaTime;
+			if (AnimInstance->Montage_IsPlaying(AttackMontage) && Replay.SwingTime < SectionTimeout) return true;
+
+			FIntPoint& SwingsAndHits = Replay.SwingsAndHitsPerSection.FindOrAdd(Replay.Swings[Replay.NextSwing - 1]);
+			SwingsAndHits.X += 1;
+			SwingsAndHits.Y += Enemy->GetNumMeleeHits() - Replay.HitsBeforeSwing;
+			Replay.bSwinging = false;
+		}
+
+		if (Replay.NextSwing >= Replay.Swings.Num())
+		{
+			Finish();
+			return false;
+		}
+
+		// One section per swing, without following its link to the next section
+		const FName Section{ Replay.Swings[Replay.NextSwing++] };
+		AnimInstance->Montage_Play(AttackMontage);
+		AnimInstance->Montage_JumpToSection(Section, AttackMontage);
+		AnimInstance->Montage_SetNextSection(Section, NAME_None, AttackMontage);
+
+		Replay.HitsBeforeSwing = Enemy->GetNumMeleeHits();
+		Replay.SwingTime = 0.f;
+		Replay.bSwinging = true;
+		return true;
+	}
+
+	static void Start(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World) return;
+		if (Replay.TickerHandle.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("MeleeReplay: already running"));
+			return;
+		}
+
+		APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+		if (!Player) return;
+
+		AEnemy* Enemy = nullptr;
+		float ClosestDistanceSquared{ TNumericLimits<float>::Max() };
+		for (TActorIterator<AEnemy> It(World); It; ++It)
+		{
+			const float DistanceSquared{ FVector::DistSquared(It->GetActorLocation(), Player->GetActorLocation()) };
+			if (!It->IsDying() && It->GetAttackMontage() && !It->IsHidden() && DistanceSquared < ClosestDistanceSquared)
+			{
+				Enemy = *It;
+				ClosestDistanceSquared = DistanceSquared;
+			}
+		}
+		if (!Enemy)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("MeleeReplay: needs an enemy with an attack montage in the world"));
+			return;
+		}
+
+		const int32 NumRepeats{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 3 };
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			for (const FCompositeSection& Section : Enemy->GetAttackMontage()->CompositeSections)
+			{
+				Replay.Swings.Add(Section.SectionName);
+			}
+		}
+
+		if (Enemy->GetEnemyController() && Enemy->GetEnemyController()->GetBrainComponent())
+		{
+			Enemy->GetEnemyController()->StopMovement();
+			Enemy->GetEnemyController()->GetBrainComponent()->PauseLogic(TEXT("MeleeReplay"));
+		}
+
+		const FVector Forward{ Player->GetActorForwardVector().GetSafeNormal2D() };
+		Enemy->SetActorLocationAndRotation(
+			Player->GetActorLocation() + Forward * AttackDistance,
+			(-Forward).Rotation(),
+			false,
+			nullptr,
+			ETeleportType::TeleportPhysics);
+
+		Replay.Enemy = Enemy;
+		Replay.TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs MeleeReplayCommand(
+	TEXT("us.Melee.Replay"),
+	TEXT("Plays every attack montage section of the enemy closest to the player N times (default 3) at the player and counts the hits"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&MeleeReplay::Start)
+);
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * Hit detection of one melee weapon: the blade between a base and a tip socket is swept as a capsule
+ * from its pose at the last sweep to its current pose, in substeps so fast swings can't skip a target.
+ * Each actor is hit at most once per swing, from Start to Stop.
+ */
+struct FMeleeSweep
+{
+public:
+
+	/** Starts a swing from the current pose of the sockets, sweeping a capsule of the given radius */
+	void Start(const USkeletalMeshComponent* Mesh, FName InBaseSocket, FName InTipSocket, float InRadius);
+
+	void Stop();
+
+	/**
+	* Sweeps the blade up to its current pose.
+	* @param Params Query params, should ignore the owner
+	* @param OutNewHits Receives one hit per actor not hit yet this swing
+	*/
+	void Sweep(const USkeletalMeshComponent* Mesh, const FCollisionQueryParams& Params, TArray<FHitResult>& OutNewHits);
+
+	FORCEINLINE bool IsActive() const { return bActive; }
+
+private:
+
+	FName BaseSocket;
+	FName TipSocket;
+	float Radius = 0.f;
+
+	FVector LastBase = FVector::ZeroVector;
+	FVector LastTip = FVector::ZeroVector;
+
+	/** Actors hit this swing */
+	TArray<TWeakObjectPtr<AActor>, TInlineAllocator<4>> HitActors;
+
+	bool bActive = false;
+};
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NoiseEventSubsystem.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Resolve Noises"), STAT_ResolveNoises, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noises Posted"), STAT_NoisesPosted, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noises Resolved"), STAT_NoisesResolved, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Alerts"), STAT_NoiseAlerts, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<float> CVarNoiseAlertWindow(
+	TEXT("us.Noise.AlertWindow"),
+	1.f,
+	TEXT("Seconds before the same enemy can be alerted by noise again"));
+
+static TAutoConsoleVariable<int32> CVarNoiseOcclusion(
+	TEXT("us.Noise.Occlusion"),
+	0,
+	TEXT("1 traces from each noise to the enemies in range, occluded enemies hear it over us.Noise.OcclusionFalloff of the range"));
+
+static TAutoConsoleVariable<float> CVarNoiseOcclusionFalloff(
+	TEXT("us.Noise.OcclusionFalloff"),
+	0.5f,
+	TEXT("Fraction of its range an occluded noise carries to"));
+
+void UNoiseEventSubsystem::PostNoise(AActor* Instigator, const FVector& Location, float Loudness)
+{
+	if (UNoiseEventSubsystem* NoiseEvents = Get(Instigator))
+	{
+		NoiseEvents->AddNoise(Instigator, Location, Loudness);
+	}
+}
+
+void UNoiseEventSubsystem::AddNoise(AActor* Instigator, const FVector& Location, float Loudness)
+{
+	if (!Instigator || Loudness <= 0.f) return;
+
+	INC_DWORD_STAT(STAT_NoisesPosted);
+
+	// One noise per instigator per frame, the loudest
+	for (FNoiseEvent& Noise : PendingNoises)
+	{
+		if (Noise.Instigator == Instigator)
+		{
+			if (Loudness > Noise.Loudness)
+			{
+				Noise.Location = Location;
+				Noise.Loudness = Loudness;
+			}
+			return;
+		}
+	}
+
+	FNoiseEvent& Noise = PendingNoises.AddDefaulted_GetRef();
+	Noise.Instigator = Instigator;
+	Noise.Location = Location;
+	Noise.Loudness = Loudness;
+}
+
+UNoiseEventSubsystem* UNoiseEventSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UNoiseEventSubsystem>() : nullptr;
+}
+
+void UNoiseEventSubsystem::Tick(float DeltaTime)
+{
+	ResolveNoises();
+}
+
+ETickableTickType UNoiseEventSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UNoiseEventSubsystem::IsTickable() const
+{
+	return PendingNoises.Num() > 0;
+}
+
+TStatId UNoiseEventSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNoiseEventSubsystem, STATGROUP_Tickables);
+}
+
+void UNoiseEventSubsystem::ResolveNoises()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ResolveNoises);
+
+	const float Now{ GetWorld()->GetTimeSeconds() };
+	const float AlertWindow{ CVarNoiseAlertWindow.GetValueOnGameThread() };
+
+	for (auto It = LastAlertTimes.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || Now - It.Value() >= AlertWindow) It.RemoveCurrent();
+	}
+
+	// Handlers may post more noise, which is resolved next frame
+	TArray<FNoiseEvent> Noises = MoveTemp(PendingNoises);
+	PendingNoises.Reset();
+
+	TArray<AEnemy*> Listeners;
+	for (const FNoiseEvent& Noise : Noises)
+	{
+		if (!IsValid(Noise.Instigator)) continue;
+
+		INC_DWORD_STAT(STAT_NoisesResolved);
+
+		Listeners.Reset();
+		GatherListeners(Noise, Listeners);
+
+		TArray<FEnemyBlackboard, TInlineAllocator<16>> AlertedBlackboards;
+		for (AEnemy* Enemy : Listeners)
+		{
+			AEnemyController* EnemyController = Enemy->GetEnemyController();
+			if (!EnemyController || LastAlertTimes.Contains(Enemy)) continue;
+
+			const float AudibleRange{ GetAudibleRange(Noise, Enemy) };
+			if (FVector::DistSquared(Noise.Location, Enemy->GetActorLocation()) > FMath::Square(AudibleRange)) continue;
+
+			LastAlertTimes.Add(Enemy, Now);
+			Enemy->AlertEnemy();
+			AlertedBlackboards.Add(EnemyController->GetEnemyBlackboard());
+			INC_DWORD_STAT(STAT_NoiseAlerts);
+		}
+
+		FEnemyBlackboard::SetTargetActor(AlertedBlackboards, Noise.Instigator);
+	}
+}
+
+void UNoiseEventSubsystem::GatherListeners(const FNoiseEvent& Noise, TArray<AEnemy*>& OutEnemies) const
+{
+	UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>();
+	if (Perception && UEnemyPerceptionSubsystem::IsPerceptionEnabled())
+	{
+		Perception->QueryEnemiesInRadius(Noise.Location, Noise.Loudness, OutEnemies);
+		return;
+	}
+
+	// Enemies on overlap spheres aren't in the perception grid
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(
+		Overlaps,
+		Noise.Location,
+		FQuat::Identity,
+		FCollisionObjectQueryParams(ECollisionChannel::ECC_Pawn),
+		FCollisionShape::MakeSphere(Noise.Loudness));
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		if (AEnemy* Enemy = Cast<AEnemy>(Overlap.GetActor()))
+		{
+			OutEnemies.AddUnique(Enemy);
+		}
+	}
+}
+
+float UNoiseEventSubsystem::GetAudibleRange(const FNoiseEvent& Noise, const AEnemy* Enemy) const
+{
+	if (CVarNoiseOcclusion.GetValueOnGameThread() == 0) return Noise.Loudness;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NoiseOcclusion));
+	QueryParams.AddIgnoredActor(Noise.Instigator);
+	QueryParams.AddIgnoredActor(Enemy);
+
+	const bool bOccluded{ GetWorld()->LineTraceTestByChannel(Noise.Location, Enemy->GetActorLocation(), ECollisionChannel::ECC_Visibility, QueryParams) };
+	return bOccluded ? Noise.Loudness * CVarNoiseOcclusionFalloff.GetValueOnGameThread() : Noise.Loudness;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "NoiseEventSubsystem.generated.h"
+
+class AEnemy;
+
+/** A noise heard this frame */
+USTRUCT()
+struct FNoiseEvent
+{
+	GENERATED_BODY()
+
+	/** Who enemies are alerted to */
+	UPROPERTY()
+	AActor* Instigator = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+
+	/** Range the noise carries to, unoccluded */
+	float Loudness = 0.f;
+};
+
+/**
+ * Turns gunfire into enemy alerts.
+ * Noises posted during a frame are merged per instigator and resolved once, after the frame's timers,
+ * against the enemy perception grid. Occluded enemies can hear a noise over a shorter range, and
+ * each enemy is alerted at most once per us.Noise.AlertWindow.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UNoiseEventSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Posts a noise to the subsystem of the instigator's world */
+	static void PostNoise(AActor* Instigator, const FVector& Location, float Loudness);
+
+	void AddNoise(AActor* Instigator, const FVector& Location, float Loudness);
+
+	static UNoiseEventSubsystem* Get(const UObject* WorldContextObject);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	/** Resolves this frame's noises into alerts */
+	void ResolveNoises();
+
+	/** Enemies within range of the noise */
+	void GatherListeners(const FNoiseEvent& Noise, TArray<AEnemy*>& OutEnemies) const;
+
+	/** Range left after occlusion, 0 when the enemy can't hear it */
+	float GetAudibleRange(const FNoiseEvent& Noise, const AEnemy* Enemy) const;
+
+	UPROPERTY()
+	TArray<FNoiseEvent> PendingNoises;
+
+	/** World time each enemy was last alerted */
+	TMap<TWeakObjectPtr<AEnemy>, float> LastAlertTimes;
+};
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ParticlePoolSubsystem.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Particle Pool Hits"), STAT_ParticlePoolHits, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Particle Pool Misses"), STAT_ParticlePoolMisses, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Particle Pool Steals"), STAT_ParticlePoolSteals, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Particle Pool Culled"), STAT_ParticlePoolCulled, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<int32> CVarParticlePoolMaxPerTemplate(
+	TEXT("us.ParticlePool.MaxPerTemplate"),
+	24,
+	TEXT("Max active pooled components of one particle template before the oldest is stolen"));
+
+static TAutoConsoleVariable<float> CVarParticlePoolCullDistance(
+	TEXT("us.ParticlePool.CullDistance"),
+	8000.f,
+	TEXT("Pooled effects further than this from the camera are not spawned. 0 disables culling"));
+
+void UParticlePoolSubsystem::Deinitialize()
+{
+	for (TPair<UParticleSystem*, FParticleTemplatePool>& Pool : Pools)
+	{
+		for (UParticleSystemComponent* Component : Pool.Value.Free)
+		{
+			if (IsValid(Component)) Component->DestroyComponent();
+		}
+		for (UParticleSystemComponent* Component : Pool.Value.Active)
+		{
+			if (IsValid(Component)) Component->DestroyComponent();
+		}
+	}
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FTransform& Transform)
+{
+	UParticlePoolSubsystem* ParticlePool = Get(WorldContextObject);
+	return ParticlePool ? ParticlePool->Spawn(Template, Transform) : nullptr;
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	return SpawnEmitterAtLocation(WorldContextObject, Template, FTransform(Rotation, Location));
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::SpawnEmitterAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName)
+{
+	UParticlePoolSubsystem* ParticlePool = Get(AttachToComponent);
+	return ParticlePool ? ParticlePool->SpawnAttached(Template, AttachToComponent, AttachPointName) : nullptr;
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::Spawn(UParticleSystem* Template, const FTransform& Transform)
+{
+	if (!Template) return nullptr;
+
+	if (ShouldCull(Transform.GetLocation()))
+	{
+		INC_DWORD_STAT(STAT_ParticlePoolCulled);
+		return nullptr;
+	}
+
+	UParticleSystemComponent* Component = Acquire(Template);
+	if (!Component) return nullptr;
+
+	if (Component->GetAttachParent())
+	{
+		Component->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	}
+	Component->SetWorldTransform(Transform);
+	Component->Activate(true);
+
+	return Component;
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::SpawnAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName)
+{
+	if (!Template || !AttachToComponent) return nullptr;
+
+	if (ShouldCull(AttachToComponent->GetComponentLocation()))
+	{
+		INC_DWORD_STAT(STAT_ParticlePoolCulled);
+		return nullptr;
+	}
+
+	UParticleSystemComponent* Component = Acquire(Template);
+	if (!Component) return nullptr;
+
+	Component->AttachToComponent(AttachToComponent, FAttachmentTransformRules::SnapToTargetIncludingScale, AttachPointName);
+	Component->Activate(true);
+
+	return Component;
+}
+
+void UParticlePoolSubsystem::Prewarm(UParticleSystem* Template, int32 Count)
+{
+	if (!Template) return;
+
+	FParticleTemplatePool& Pool = Pools.FindOrAdd(Template);
+	for (int32 Index = Pool.Free.Num(); Index < Count; ++Index)
+	{
+		if (UParticleSystemComponent* Component = CreatePooledComponent(Template))
+		{
+			Pool.Free.Add(Component);
+		}
+	}
+}
+
+void UParticlePoolSubsystem::SetTemplateCap(UParticleSystem* Template, int32 MaxActive)
+{
+	if (!Template) return;
+
+	Pools.FindOrAdd(Template).MaxActive = MaxActive;
+}
+
+UParticlePoolSubsystem* UParticlePoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UParticlePoolSubsystem>() : nullptr;
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::Acquire(UParticleSystem* Template)
+{
+	FParticleTemplatePool& Pool = Pools.FindOrAdd(Template);
+	UParticleSystemComponent* Component = nullptr;
+
+	// Reuse a finished component
+	while (!Component && Pool.Free.Num() > 0)
+	{
+		Component = Pool.Free.Pop(false);
+		if (!IsValid(Component)) Component = nullptr;
+	}
+
+	if (Component)
+	{
+		INC_DWORD_STAT(STAT_ParticlePoolHits);
+	}
+	else
+	{
+		Pool.Active.RemoveAll([](const UParticleSystemComponent* Active) { return !IsValid(Active); });
+
+		const int32 MaxActive{ Pool.MaxActive > 0 ? Pool.MaxActive : CVarParticlePoolMaxPerTemplate.GetValueOnGameThread() };
+		if (Pool.Active.Num() < MaxActive)
+		{
+			INC_DWORD_STAT(STAT_ParticlePoolMisses);
+			Component = CreatePooledComponent(Template);
+		}
+		else if (Pool.Active.Num() > 0)
+		{
+			// Out of budget: restart the oldest effect here instead
+			INC_DWORD_STAT(STAT_ParticlePoolSteals);
+			Component = Pool.Active[0];
+			Pool.Active.RemoveAt(0, 1, false);
+			Component->DeactivateImmediate();
+		}
+	}
+
+	if (Component)
+	{
+		Pool.Active.Add(Component);
+	}
+	return Component;
+}
+
+UParticleSystemComponent* UParticlePoolSubsystem::CreatePooledComponent(UParticleSystem* Template)
+{
+	UWorld* World = GetWorld();
+	if (!World) return nullptr;
+
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(World);
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->SecondsBeforeInactive = 0.f;
+	Component->SetTemplate(Template);
+	Component->OnSystemFinished.AddUniqueDynamic(this, &UParticlePoolSubsystem::OnPooledSystemFinished);
+	Component->RegisterComponentWithWorld(World);
+
+	return Component;
+}
+
+bool UParticlePoolSubsystem::ShouldCull(const FVector& Location) const
+{
+	const float CullDistance{ CVarParticlePoolCullDistance.GetValueOnGameThread() };
+	if (CullDistance <= 0.f) return false;
+
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController || !PlayerController->PlayerCameraManager) return false;
+
+	return FVector::DistSquared(PlayerController->PlayerCameraManager->GetCameraLocation(), Location) > FMath::Square(CullDistance);
+}
+
+void UParticlePoolSubsystem::OnPooledSystemFinished(UParticleSystemComponent* FinishedComponent)
+{
+	FParticleTemplatePool* Pool = FinishedComponent ? Pools.Find(FinishedComponent->Template) : nullptr;
+	if (!Pool) return;
+
+	// Stolen components were already taken out of the active list
+	if (Pool->Active.RemoveSingle(FinishedComponent) > 0)
+	{
+		if (FinishedComponent->GetAttachParent())
+		{
+			FinishedComponent->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+		}
+		Pool->Free.Add(FinishedComponent);
+	}
+}
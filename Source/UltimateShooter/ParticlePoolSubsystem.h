@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ParticlePoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/** Components of one particle template, oldest active first */
+USTRUCT()
+struct FParticleTemplatePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Free;
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Active;
+
+	/** Max active components of this template, 0 uses us.ParticlePool.MaxPerTemplate */
+	int32 MaxActive = 0;
+};
+
+/**
+ * Pre-warms and recycles particle system components per template, so gunfire and impacts
+ * don't create and garbage collect a component per effect.
+ * Caps the active components of each template, stealing the oldest one when the cap is hit,
+ * and skips effects too far from the camera to be seen.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UParticlePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** Spawns a pooled effect, returns null if it was culled */
+	static UParticleSystemComponent* SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FTransform& Transform);
+	static UParticleSystemComponent* SpawnEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	/** Spawns a pooled effect snapped to a component, returns null if it was culled */
+	static UParticleSystemComponent* SpawnEmitterAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName = NAME_None);
+
+	UParticleSystemComponent* Spawn(UParticleSystem* Template, const FTransform& Transform);
+
+	UParticleSystemComponent* SpawnAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName = NAME_None);
+
+	/** Creates inactive components for a template ahead of time */
+	UFUNCTION(BlueprintCallable, Category = "Particle Pool")
+	void Prewarm(UParticleSystem* Template, int32 Count);
+
+	/** Overrides the max active components of a template */
+	UFUNCTION(BlueprintCallable, Category = "Particle Pool")
+	void SetTemplateCap(UParticleSystem* Template, int32 MaxActive);
+
+	static UParticlePoolSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+
+	/** Gets a free, new or stolen component for the template, null if the template can't spawn */
+	UParticleSystemComponent* Acquire(UParticleSystem* Template);
+
+	UParticleSystemComponent* CreatePooledComponent(UParticleSystem* Template);
+
+	/** True when the location is further from the camera than us.ParticlePool.CullDistance */
+	bool ShouldCull(const FVector& Location) const;
+
+	UFUNCTION()
+	void OnPooledSystemFinished(UParticleSystemComponent* FinishedComponent);
+
+	UPROPERTY()
+	TMap<UParticleSystem*, FParticleTemplatePool> Pools;
+};
@@ -0,0 +1,297 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PatrolRouteSubsystem.h"
+#include "Enemy.h"
+#include "NavigationData.h"
+#include "NavigationSystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Project Patrol Candidates"), STAT_ProjectPatrolCandidates, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Patrol Candidates Projected"), STAT_PatrolCandidatesProjected, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Patrol Routes Assigned"), STAT_PatrolRoutesAssigned, STATGROUP_UltimateShooter);
+
+static TAutoConsoleVariable<float> CVarPatrolRegionSize(
+	TEXT("us.Patrol.RegionSize"),
+	4000.f,
+	TEXT("Side of the square regions patrol points are cached for. Takes effect after us.Patrol.Clear"));
+
+static TAutoConsoleVariable<int32> CVarPatrolPointsPerRegion(
+	TEXT("us.Patrol.PointsPerRegion"),
+	24,
+	TEXT("Random candidates projected onto the navmesh when a region is built"));
+
+static TAutoConsoleVariable<int32> CVarPatrolProjectionsPerFrame(
+	TEXT("us.Patrol.ProjectionsPerFrame"),
+	32,
+	TEXT("Candidates projected per frame, in one batch, across the regions being built"));
+
+static TAutoConsoleVariable<float> CVarPatrolProjectionHeight(
+	TEXT("us.Patrol.ProjectionHeight"),
+	1000.f,
+	TEXT("How far above and below the region's height candidates look for the navmesh"));
+
+void UPatrolRouteSubsystem::RequestRoute(AEnemy* Enemy)
+{
+	if (!Enemy) return;
+
+	CancelRoute(Enemy);
+
+	const FVector Location{ Enemy->GetActorLocation() };
+	const FIntPoint RegionKey{ GetRegion(Location) };
+	const FPatrolRegion& Region = FindOrAddRegion(RegionKey, Location.Z);
+	if (Region.IsBuilt())
+	{
+		AssignRoute(Enemy, Region);
+		return;
+	}
+
+	Requests.Add({ Enemy, RegionKey });
+}
+
+void UPatrolRouteSubsystem::CancelRoute(AEnemy* Enemy)
+{
+	Requests.RemoveAllSwap([Enemy](const FPatrolRouteRequest& Request) { return Request.Enemy == Enemy; });
+}
+
+bool UPatrolRouteSubsystem::FindPatrolPoint(const FVector& Origin, float Radius, float MinDistance, const FVector* LastPoint, FVector& OutPoint)
+{
+	const FPatrolRegion& Region = FindOrAddRegion(GetRegion(Origin), Origin.Z);
+	if (!Region.IsBuilt() || Region.Points.Num() == 0) return false;
+
+	// Random start, so enemies sharing a region spread over its points
+	const float RadiusSquared{ FMath::Square(Radius) };
+	const float MinDistanceSquared{ FMath::Square(MinDistance) };
+	const int32 NumPoints{ Region.Points.Num() };
+	const int32 FirstIndex{ FMath::RandHelper(NumPoints) };
+
+	bool bFound{ false };
+	for (int32 Offset = 0; Offset < NumPoints; ++Offset)
+	{
+		const FVector& Point = Region.Points[(FirstIndex + Offset) % NumPoints];
+		const float DistanceSquared{ FVector::DistSquared(Point, Origin) };
+		if (DistanceSquared > RadiusSquared) continue;
+
+		// Settle for a point in range if none is far enough from the last one
+		OutPoint = Point;
+		bFound = true;
+		if (DistanceSquared >= MinDistanceSquared && (!LastPoint || FVector::DistSquared(Point, *LastPoint) >= MinDistanceSquared)) break;
+	}
+	return bFound;
+}
+
+void UPatrolRouteSubsystem::ClearCache()
+{
+	Regions.Reset();
+	BuildQueue.Reset();
+	++Generation;
+}
+
+UPatrolRouteSubsystem* UPatrolRouteSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UPatrolRouteSubsystem>() : nullptr;
+}
+
+void UPatrolRouteSubsystem::Tick(float DeltaTime)
+{
+	ProjectCandidates();
+	ServeRequests();
+}
+
+ETickableTickType UPatrolRouteSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UPatrolRouteSubsystem::IsTickable() const
+{
+	return BuildQueue.Num() > 0 || Requests.Num() > 0;
+}
+
+TStatId UPatrolRouteSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPatrolRouteSubsystem, STATGROUP_Tickables);
+}
+
+FIntPoint UPatrolRouteSubsystem::GetRegion(const FVector& Location) const
+{
+	const float RegionSize{ FMath::Max(CVarPatrolRegionSize.GetValueOnGameThread(), 100.f) };
+	return FIntPoint(FMath::FloorToInt(Location.X / RegionSize), FMath::FloorToInt(Location.Y / RegionSize));
+}
+
+FPatrolRegion& UPatrolRouteSubsystem::FindOrAddRegion(const FIntPoint& RegionKey, float Height)
+{
+	if (FPatrolRegion* Region = Regions.Find(RegionKey))
+	{
+		return *Region;
+	}
+
+	FPatrolRegion& Region = Regions.Add(RegionKey);
+	Region.Height = Height;
+	Region.NumCandidatesLeft = FMath::Max(CVarPatrolPointsPerRegion.GetValueOnGameThread(), 2);
+	BuildQueue.Add(RegionKey);
+	return Region;
+}
+
+void UPatrolRouteSubsystem::ProjectCandidates()
+{
+	if (BuildQueue.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_ProjectPatrolCandidates);
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (!NavData) return;
+
+	const float RegionSize{ FMath::Max(CVarPatrolRegionSize.GetValueOnGameThread(), 100.f) };
+	const float ProjectionHeight{ CVarPatrolProjectionHeight.GetValueOnGameThread() };
+	int32 Budget{ FMath::Max(CVarPatrolProjectionsPerFrame.GetValueOnGameThread(), 1) };
+
+	// One batch for every region being built this frame, regions without an anchor only send one candidate
+	// since the rest are path tested from it
+	TArray<FNavigationProjectionWork> Workload;
+	TArray<FIntPoint, TInlineAllocator<8>> WorkloadRegions;
+	TArray<int32, TInlineAllocator<8>> WorkloadEnds;
+	for (const FIntPoint& RegionKey : BuildQueue)
+	{
+		if (Budget <= 0) break;
+
+		FPatrolRegion& Region = Regions[RegionKey];
+		const int32 NumCandidates{ Region.bHasAnchor ? FMath::Min(Region.NumCandidatesLeft, Budget) : 1 };
+		const FVector RegionMin{ RegionKey.X * RegionSize, RegionKey.Y * RegionSize, Region.Height };
+		for (int32 Candidate = 0; Candidate < NumCandidates; ++Candidate)
+		{
+			const FVector Point{ RegionMin + FVector(FMath::FRand() * RegionSize, FMath::FRand() * RegionSize, 0.f) };
+			Workload.Emplace(Point, FBox(Point - FVector(0.f, 0.f, ProjectionHeight), Point + FVector(0.f, 0.f, ProjectionHeight)));
+		}
+		Region.NumCandidatesLeft -= NumCandidates;
+		Budget -= NumCandidates;
+		WorkloadRegions.Add(RegionKey);
+		WorkloadEnds.Add(Workload.Num());
+	}
+
+	NavSys->BatchProjectPoints(Workload, NavData);
+	INC_DWORD_STAT_BY(STAT_PatrolCandidatesProjected, Workload.Num());
+
+	int32 WorkIndex{ 0 };
+	for (int32 Index = 0; Index < WorkloadRegions.Num(); ++Index)
+	{
+		const FIntPoint& RegionKey = WorkloadRegions[Index];
+		FPatrolRegion& Region = Regions[RegionKey];
+		for (; WorkIndex < WorkloadEnds[Index]; ++WorkIndex)
+		{
+			const FNavigationProjectionWork& Work = Workload[WorkIndex];
+			if (!Work.bResult) continue;
+
+			const FVector Point{ Work.OutLocation.Location };
+			if (!Region.bHasAnchor)
+			{
+				Region.Anchor = Point;
+				Region.bHasAnchor = true;
+				Region.Points.Add(Point);
+				continue;
+			}
+
+			// Points on navmesh islands the anchor can't walk to never make it into the cache
+			FPathFindingQuery Query(this, *NavData, Region.Anchor, Point);
+			NavSys->FindPathAsync(
+				NavData->GetConfig(),
+				Query,
+				FNavPathQueryDelegate::CreateUObject(this, &UPatrolRouteSubsystem::OnPathTested, RegionKey, Point, Generation),
+				EPathFindingMode::Hierarchical);
+			++Region.NumPathTestsPending;
+		}
+	}
+
+	BuildQueue.RemoveAll([this](const FIntPoint& RegionKey) { return Regions[RegionKey].NumCandidatesLeft <= 0; });
+}
+
+void UPatrolRouteSubsystem::OnPathTested(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, FIntPoint RegionKey, FVector Point, int32 QueryGeneration)
+{
+	FPatrolRegion* Region = QueryGeneration == Generation ? Regions.Find(RegionKey) : nullptr;
+	if (!Region) return;
+
+	--Region->NumPathTestsPending;
+	if (Result == ENavigationQueryResult::Success && Path.IsValid() && !Path->IsPartial())
+	{
+		Region->Points.Add(Point);
+	}
+}
+
+void UPatrolRouteSubsystem::ServeRequests()
+{
+	for (int32 Index = Requests.Num() - 1; Index >= 0; --Index)
+	{
+		const FPatrolRouteRequest& Request = Requests[Index];
+		const FPatrolRegion* Region = Regions.Find(Request.Region);
+		AEnemy* Enemy = Request.Enemy.Get();
+		if (Enemy && Region && !Region->IsBuilt()) continue;
+
+		// Requests of cleared regions are dropped along with them
+		if (Enemy && Region)
+		{
+			AssignRoute(Enemy, *Region);
+		}
+		Requests.RemoveAtSwap(Index);
+	}
+}
+
+void UPatrolRouteSubsystem::AssignRoute(AEnemy* Enemy, const FPatrolRegion& Region) const
+{
+	// Regions with a single reachable point leave the enemy on its placed points
+	const int32 NumPoints{ Region.Points.Num() };
+	if (NumPoints < 2) return;
+
+	const int32 FirstIndex{ FMath::RandHelper(NumPoints) };
+	const int32 SecondIndex{ (FirstIndex + 1 + FMath::RandHelper(NumPoints - 1)) % NumPoints };
+	Enemy->SetPatrolRoute(Region.Points[FirstIndex], Region.Points[SecondIndex]);
+	INC_DWORD_STAT(STAT_PatrolRoutesAssigned);
+}
+
+void UPatrolRouteSubsystem::DumpStats() const
+{
+	int32 NumBuilt{ 0 };
+	int32 NumPoints{ 0 };
+	int32 NumPathTestsPending{ 0 };
+	for (const TPair<FIntPoint, FPatrolRegion>& Pair : Regions)
+	{
+		NumBuilt += Pair.Value.IsBuilt() ? 1 : 0;
+		NumPoints += Pair.Value.Points.Num();
+		NumPathTestsPending += Pair.Value.NumPathTestsPending;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("PatrolRoutes: %d regions (%d built), %d cached points, %d path tests pending, %d enemies waiting"),
+		Regions.Num(),
+		NumBuilt,
+		NumPoints,
+		NumPathTestsPending,
+		Requests.Num());
+}
+
+static FAutoConsoleCommandWithWorld PatrolStatsCommand(
+	TEXT("us.Patrol.Stats"),
+	TEXT("Logs the cached patrol regions and the enemies waiting for a route"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UPatrolRouteSubsystem* PatrolRoutes = UPatrolRouteSubsystem::Get(World))
+		{
+			PatrolRoutes->DumpStats();
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld PatrolClearCommand(
+	TEXT("us.Patrol.Clear"),
+	TEXT("Drops the cached patrol regions, they are rebuilt the next time an enemy patrols in them"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UPatrolRouteSubsystem* PatrolRoutes = UPatrolRouteSubsystem::Get(World))
+		{
+			PatrolRoutes->ClearCache();
+		}
+	})
+);
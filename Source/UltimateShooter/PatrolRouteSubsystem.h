@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "PatrolRouteSubsystem.generated.h"
+
+class AEnemy;
+
+/** Patrol points cached for one us.Patrol.RegionSize square of the world */
+struct FPatrolRegion
+{
+	/** Navmesh points reachable from the anchor */
+	TArray<FVector> Points;
+
+	/** First point found on the navmesh, the others are path tested from it */
+	FVector Anchor = FVector::ZeroVector;
+	bool bHasAnchor = false;
+
+	/** Height candidates are projected around, from whoever first asked for the region */
+	float Height = 0.f;
+
+	int32 NumCandidatesLeft = 0;
+	int32 NumPathTestsPending = 0;
+
+	FORCEINLINE bool IsBuilt() const { return NumCandidatesLeft == 0 && NumPathTestsPending == 0; }
+};
+
+/** An enemy waiting for its region to be built */
+struct FPatrolRouteRequest
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+	FIntPoint Region;
+};
+
+/**
+ * Hands out patrol points from a per region cache, instead of every enemy querying the navmesh as it spawns.
+ * A region is built the first time someone patrols in it: random candidates are projected onto the navmesh
+ * in batches of us.Patrol.ProjectionsPerFrame, and the projected points are path tested from the region's anchor
+ * with async path queries, so only reachable points are cached. Enemies asking for a route while their region builds
+ * keep their placed patrol points until it is done.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UPatrolRouteSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Gives the enemy two cached patrol points around it, now if its region is built or once it is */
+	void RequestRoute(AEnemy* Enemy);
+
+	void CancelRoute(AEnemy* Enemy);
+
+	/**
+	 * A cached point within Radius of Origin and at least MinDistance from it and from LastPoint, if given.
+	 * Returns false while the region is being built, which starts building it.
+	 */
+	bool FindPatrolPoint(const FVector& Origin, float Radius, float MinDistance, const FVector* LastPoint, FVector& OutPoint);
+
+	/** Drops every cached region, e.g. after the navmesh changed */
+	void ClearCache();
+
+	static UPatrolRouteSubsystem* Get(const UObject* WorldContextObject);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+	void DumpStats() const;
+
+private:
+
+	FIntPoint GetRegion(const FVector& Location) const;
+
+	/** The region, queued for building if it is new */
+	FPatrolRegion& FindOrAddRegion(const FIntPoint& RegionKey, float Height);
+
+	/** Projects the next batch of candidates and starts path testing them */
+	void ProjectCandidates();
+
+	void OnPathTested(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, FIntPoint RegionKey, FVector Point, int32 Generation);
+
+	/** Assigns routes to the enemies whose region is built */
+	void ServeRequests();
+
+	void AssignRoute(AEnemy* Enemy, const FPatrolRegion& Region) const;
+
+	TMap<FIntPoint, FPatrolRegion> Regions;
+
+	/** Regions with candidates left to project, oldest first */
+	TArray<FIntPoint> BuildQueue;
+
+	TArray<FPatrolRouteRequest> Requests;
+
+	/** Bumped by ClearCache, so path tests of dropped regions are ignored */
+	int32 Generation = 0;
+};
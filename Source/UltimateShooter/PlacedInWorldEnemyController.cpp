@@ -29,6 +29,7 @@ void APlacedInWorldEnemyController::OnPossess(APawn* InPawn)
 		if (Enemy->GetBehaviorTree())
 		{
 			BlackboardComponent->InitializeBlackboard(*(Enemy->GetBehaviorTree()->BlackboardAsset));
+			EnemyBlackboard = FEnemyBlackboard(BlackboardComponent);
 		}
 	}
 }
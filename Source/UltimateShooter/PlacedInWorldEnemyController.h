@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "EnemyBlackboard.h"
 #include "PlacedInWorldEnemyController.generated.h"
 
 /**
@@ -29,7 +30,13 @@ private:
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 		class UBehaviorTreeComponent* BehaviorTreeComponent;
 
+	/** Blackboard with its key IDs resolved */
+	FEnemyBlackboard EnemyBlackboard;
+
 public:
 
 	FORCEINLINE UBlackboardComponent* GetBlackboardComponent() const { return BlackboardComponent; }
+
+	/** Typed access to the blackboard, valid once an enemy is possessed */
+	FORCEINLINE const FEnemyBlackboard& GetEnemyBlackboard() const { return EnemyBlackboard; }
 };
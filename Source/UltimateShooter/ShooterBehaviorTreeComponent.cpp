@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterBehaviorTreeComponent.h"
+#include "Engine/World.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Behavior Tree Tick"), STAT_EnemyBehaviorTreeTick, STATGROUP_UltimateShooter);
+
+double UShooterBehaviorTreeComponent::TotalTickSeconds = 0.0;
+
+void UShooterBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyBehaviorTreeTick);
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	TotalTickSeconds += FPlatformTime::Seconds() - StartTime;
+
+	++NumTicks;
+
+	// Super scheduled the next tick, ScheduleNextTick isn't virtual so the clamp goes on afterwards
+	ClampTickInterval();
+}
+
+void UShooterBehaviorTreeComponent::SetMinTickInterval(float Interval)
+{
+	MinTickInterval = FMath::Max(Interval, 0.f);
+
+	// A lower minimum takes effect when the tree schedules its next tick
+	ClampTickInterval();
+}
+
+void UShooterBehaviorTreeComponent::ClampTickInterval()
+{
+	// Tick is disabled while the tree has nothing to do, leave it that way
+	if (MinTickInterval > 0.f && IsComponentTickEnabled() && GetComponentTickInterval() < MinTickInterval)
+	{
+		SetComponentTickIntervalAndCooldown(MinTickInterval);
+	}
+}
+
+float UShooterBehaviorTreeComponent::ConsumeTickRate()
+{
+	const UWorld* World = GetWorld();
+	const float Now{ World ? World->GetTimeSeconds() : 0.f };
+	const float Elapsed{ Now - TickCountStartTime };
+	const float TickRate{ Elapsed > 0.f ? NumTicks / Elapsed : 0.f };
+
+	NumTicks = 0;
+	TickCountStartTime = Now;
+	return TickRate;
+}
+
+double UShooterBehaviorTreeComponent::ConsumeTickSeconds()
+{
+	const double TickSeconds{ TotalTickSeconds };
+	TotalTickSeconds = 0.0;
+	return TickSeconds;
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "ShooterBehaviorTreeComponent.generated.h"
+
+/**
+ * Behavior tree component that reports its cost: the tick time of every enemy behavior tree shows in
+ * stat UltimateShooter, and is summed for benchmarks, which read and reset it with ConsumeTickSeconds.
+ *
+ * It is also where significance throttles the tree. The base component sets its own tick interval
+ * every time it schedules the next tick, so an interval set from outside is lost on the next tick;
+ * the minimum interval is applied on top of whatever the tree scheduled instead.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UShooterBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** The tree ticks at most once per interval, 0 leaves it to the tree */
+	void SetMinTickInterval(float Interval);
+
+	/** Ticks per second since the last call */
+	float ConsumeTickRate();
+
+	/** Tick time of every behavior tree since the last call */
+	static double ConsumeTickSeconds();
+
+private:
+
+	/** Raises the interval the tree scheduled to the minimum */
+	void ClampTickInterval();
+
+	float MinTickInterval = 0.f;
+
+	/** Ticks counted for ConsumeTickRate, and the world time the count started */
+	int32 NumTicks = 0;
+	float TickCountStartTime = 0.f;
+
+	static double TotalTickSeconds;
+
+public:
+
+	FORCEINLINE float GetMinTickInterval() const { return MinTickInterval; }
+};
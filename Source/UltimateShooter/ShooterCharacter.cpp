@@ -28,8 +28,14 @@
 #include "GameFramework/GameState.h"
 #include "ShooterGameState.h"
 #include "MarkedExecutionDamageType.h"
+#include "HitscanBatch.h"
+#include "ParticlePoolSubsystem.h"
+#include "CombatAudioSubsystem.h"
+#include "NoiseEventSubsystem.h"
 
 
+DECLARE_CYCLE_STAT(TEXT("TraceForItems"), STAT_TraceForItems, STATGROUP_UltimateShooter);
+
 // Sets default values
 AShooterCharacter::AShooterCharacter() :
 	// Turning and LookUp rates
@@ -69,12 +75,14 @@ AShooterCharacter::AShooterCharacter() :
 	bAutoFireButtonPressed(false),
 	// Item Tracing
 	bShouldTraceForItems(false),
+	bAsyncItemTrace(true),
 	// Camera Interp Distances
 	CameraInterpDistance(250.f),
 	CameraInterpElevation(65.f),
 	// Ammo defaults
 	Starting9mmAmmo(85),
 	StartingARAmmo(125),
+	StartingShellAmmo(24),
 	// Combat State
 	CombatState(ECombatState::ECS_UnOccupied),
 	// Movement
@@ -138,6 +146,9 @@ AShooterCharacter::AShooterCharacter() :
 	NoiseRangeSphere = CreateDefaultSubobject<USphereComponent>(TEXT("Noise Range Sphere"));
 	NoiseRangeSphere->SetSphereRadius(200.f);
 	NoiseRangeSphere->SetupAttachment(GetRootComponent());
+	// Only shows the noise range, shots are heard through the noise event subsystem
+	NoiseRangeSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	NoiseRangeSphere->SetGenerateOverlapEvents(false);
 
 	/** Create a Camera Boom: Pulls in towards the character if there's a collision **/
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("Camera Boom"));
@@ -256,7 +267,7 @@ void AShooterCharacter::Die()
 
 		if (DeathSound)
 		{
-			UGameplayStatics::PlaySoundAtLocation(this, DeathSound, GetActorLocation());
+			UCombatAudioSubsystem::PlaySoundAtLocation(this, DeathSound, GetActorLocation(), ECombatAudioCategory::ECAC_Death);
 		}
 	}
 }
@@ -290,7 +301,7 @@ void AShooterCharacter::NotifyCharacterDeathToEnemyBB(AController* EventInstigat
 
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("CharacterDead"), true);
+		EnemyController->GetEnemyBlackboard().SetCharacterDead(true);
 	}
 }
 
@@ -325,8 +336,8 @@ void AShooterCharacter::PlayPainSound(float DamageTaken, float HeavyPainThreshol
 	if (PainSound && HeavyPainSound)
 	{
 		DamageTaken > HeavyPainThreshold ?
-			UGameplayStatics::PlaySoundAtLocation(this, HeavyPainSound, GetActorLocation()) :
-			UGameplayStatics::PlaySoundAtLocation(this, PainSound, GetActorLocation());
+			UCombatAudioSubsystem::PlaySoundAtLocation(this, HeavyPainSound, GetActorLocation(), ECombatAudioCategory::ECAC_Vocal) :
+			UCombatAudioSubsystem::PlaySoundAtLocation(this, PainSound, GetActorLocation(), ECombatAudioCategory::ECAC_Vocal);
 	}
 }
 
@@ -392,10 +403,11 @@ void AShooterCharacter::PlayArmorNegationSound() const
 {
 	if (ArmorNegationSound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			GetWorld(),
 			ArmorNegationSound,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Impact
 		);
 	}
 }
@@ -406,10 +418,11 @@ void AShooterCharacter::PlayArmorNegationEmote() const
 
 	if (ArmorNegationEmote && EmoteChance > 0.5f) // Change this back to 0.5 or above
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			GetWorld(),
 			ArmorNegationEmote,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Vocal
 		);
 	}
 }
@@ -420,10 +433,11 @@ void AShooterCharacter::PlayExplosionSlowMoEmote()
 
 	if (ExplosionSlowMoEmoteSound && EmoteChance > 0.2f)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			GetWorld(),
 			ExplosionSlowMoEmoteSound,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Vocal
 		);
 	}
 }
@@ -657,10 +671,11 @@ void AShooterCharacter::PlayCriticalHitEmote()
 
 	if (BulletTimeCriticalHitEmote && EmoteChance > 0.2f)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
+		UCombatAudioSubsystem::PlaySoundAtLocation(
 			GetWorld(),
 			BulletTimeCriticalHitEmote,
-			GetActorLocation()
+			GetActorLocation(),
+			ECombatAudioCategory::ECAC_Vocal
 		);
 	}
 }
@@ -728,24 +743,6 @@ void AShooterCharacter::PlayMarkedExecutionSound()
 	}
 }
 
-void AShooterCharacter::AlertEnemiesInNoiseRange(TArray<AActor*> EnemiesInRange)
-{
-	for (auto Enemy : EnemiesInRange)
-	{
-		auto EnemyInRange = Cast<AEnemy>(Enemy);
-		if (EnemyInRange)
-		{
-			auto EnemyController = Cast<AEnemyController>(EnemyInRange->GetController());
-			if (EnemyController)
-			{
-				EnemyInRange->AlertEnemy();
-				EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("TargetActor"), this);
-			}
-		}
-	}
-	// Alert Enemies in the Given TArray
-}
-
 	// Called when the game starts or when spawned
 void AShooterCharacter::BeginPlay()
 {
@@ -753,6 +750,17 @@ void AShooterCharacter::BeginPlay()
 
 	DefaultBaseMovementSpeed = BaseMovementSpeed;
 
+	AsyncItemTraceDelegate.BindUObject(this, &AShooterCharacter::OnAsyncItemTraceDone);
+
+	ShotRandomStream.GenerateNewSeed();
+
+	// Every shot spawns these, have them ready before the first one
+	if (UParticlePoolSubsystem* ParticlePool = UParticlePoolSubsystem::Get(this))
+	{
+		ParticlePool->Prewarm(SmokeBeam, 8);
+		ParticlePool->Prewarm(ImpactParticles, 8);
+	}
+
 	DefaultCameraFOV = FollowCamera->FieldOfView;
 	CurrentCameraFOV = DefaultCameraFOV;
 
@@ -760,9 +768,6 @@ void AShooterCharacter::BeginPlay()
 	auto* GameState = Cast<AShooterGameState>(GetWorld()->GetGameState());
 	if (GameState)
 	{
-		float LevelNoiseRangeModifier = GameState->GetLevelNoiseModifier();
-		NoiseRangeSphere->SetSphereRadius(NoiseRangeSphere->GetUnscaledSphereRadius() * LevelNoiseRangeModifier);
-
 		// Set Screen Fringe
 		DefaultSceneFringe = GameState->GetDefaultSceneFringe();
 		// Set Vignette
@@ -922,9 +927,8 @@ void AShooterCharacter::FireWeapon()
 		SendBullet();
 		PlayGunfireMontage();
 
-		// TODO: Get Enemies In Range
-		// TODO: Do a Random Chance or Timeout??
-		AlertEnemiesInNoiseRange(GetEnemiesInNoiseRange());
+		// Alert enemies within earshot of the shot
+		UNoiseEventSubsystem::PostNoise(this, GetActorLocation(), GetNoiseLoudness());
 		
 		EquippedWeapon->DecrementAmmo();
 		/** Start Timer for crosshair spread factor when firing */
@@ -1280,12 +1284,13 @@ void AShooterCharacter::StartExplosionSlowMoEmote()
 	}
 }
 
-TArray<class AActor*> AShooterCharacter::GetEnemiesInNoiseRange()
+float AShooterCharacter::GetNoiseLoudness() const
 {
-	TArray<AActor*> EnemiesInRange;
-	GetOverlappingActors(EnemiesInRange, AEnemy::StaticClass());
+	if (!EquippedWeapon) return 0.f;
 
-	return EnemiesInRange;
+	auto* GameState = Cast<AShooterGameState>(GetWorld()->GetGameState());
+	const float LevelNoiseModifier{ GameState ? GameState->GetLevelNoiseModifier() : 1.f };
+	return EquippedWeapon->GetNoiseRange() * LevelNoiseModifier;
 }
 
 int32 AShooterCharacter::GetInterpLocationIndex()
@@ -1545,6 +1550,20 @@ void AShooterCharacter::AutoFireReleased()
 	bAutoFireButtonPressed = false;
 }
 
+void AShooterCharacter::SetAutoFireHeld(bool bHeld)
+{
+	if (bHeld == bAutoFireButtonPressed) return;
+
+	if (bHeld)
+	{
+		AutoFirePressed();
+	}
+	else
+	{
+		AutoFireReleased();
+	}
+}
+
 void AShooterCharacter::StartAutoFire()
 {
 	if (!EquippedWeapon) return;
@@ -1582,37 +1601,15 @@ void AShooterCharacter::ResetAutoFire()
 
 bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation)
 {
-	FVector2D ViewportSize;
-
-	if (GEngine && GEngine->GameViewport)
-	{
-		GEngine->GameViewport->GetViewportSize(ViewportSize);
-	}
-
-	FVector2D CrosshairLocation{ ViewportSize.X / 2.f, ViewportSize.Y / 2.f };
-	FVector CrosshairWorldLocation;
-	FVector CrosshairWorldDirection;
-
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(
+	// Shared with every other crosshair query this frame
+	bool bCrosshairQuery = CrosshairQueryCache.Query(
 		UGameplayStatics::GetPlayerController(this, 0),
-		CrosshairLocation,
-		CrosshairWorldLocation,
-		CrosshairWorldDirection
+		OutHitResult,
+		OutHitLocation
 	);
 
-	if (bScreenToWorld)
+	if (bCrosshairQuery)
 	{
-		FVector Start{ CrosshairWorldLocation };
-		FVector End{ CrosshairWorldLocation + CrosshairWorldDirection * 50'000 };
-		OutHitLocation = End;
-
-		GetWorld()->LineTraceSingleByChannel(
-			OutHitResult,
-			Start,
-			End,
-			ECollisionChannel::ECC_Visibility
-		);
-
 		if (OutHitResult.bBlockingHit)
 		{
 			const USkeletalMeshSocket* BarrelSocket = EquippedWeapon->GetItemMesh()->GetSocketByName("BarrelSocket");
@@ -1638,82 +1635,127 @@ bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector&
 // Trace for items in Tick() if bShouldTraceForItems is true (OverlappedItem count > 0)
 void AShooterCharacter::TraceForItems()
 {
+	SCOPE_CYCLE_COUNTER(STAT_TraceForItems);
+
 	if (bShouldTraceForItems)
 	{
-		FHitResult CrosshairTraceHit;
-		FVector HitLocation;
-		bool bTraceSuccessful = TraceUnderCrosshairs(CrosshairTraceHit, HitLocation);
-
-		if (CrosshairTraceHit.bBlockingHit)
+		if (bAsyncItemTrace)
+		{
+			// Result is applied next frame in OnAsyncItemTraceDone()
+			StartAsyncItemTrace();
+		}
+		else
 		{
+			FHitResult CrosshairTraceHit;
+			FVector HitLocation;
+			TraceUnderCrosshairs(CrosshairTraceHit, HitLocation);
 
-			TraceHitItem = Cast<AItem>(CrosshairTraceHit.Actor);
-			auto TraceHitWeapon = Cast<AWeapon>(TraceHitItem);
-			
-			if (TraceHitWeapon)
+			UpdateTraceHitItem(CrosshairTraceHit);
+		}
+	}
+	else if (IsValid(TraceHitItemLastFrame))
+	{
+		// No longer overlapping any items
+		// Hide the last traced item if its not null
+		TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
+		TraceHitItemLastFrame->DisableCustomDepth();
+	}
+}
+
+void AShooterCharacter::StartAsyncItemTrace()
+{
+	// Only one trace in flight, the next one goes out once its result is in
+	if (AsyncItemTraceHandle.IsValid()) return;
+
+	FVector Start;
+	FVector End;
+	if (!FCrosshairQueryCache::GetCrosshairRay(UGameplayStatics::GetPlayerController(this, 0), Start, End)) return;
+
+	AsyncItemTraceHandle = GetWorld()->AsyncLineTraceByChannel(
+		EAsyncTraceType::Single,
+		Start,
+		End,
+		ECollisionChannel::ECC_Visibility,
+		FCollisionQueryParams::DefaultQueryParam,
+		FCollisionResponseParams::DefaultResponseParam,
+		&AsyncItemTraceDelegate
+	);
+}
+
+void AShooterCharacter::OnAsyncItemTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if (TraceHandle != AsyncItemTraceHandle) return;
+	AsyncItemTraceHandle = FTraceHandle();
+
+	// Items may have been left or the mode switched while the trace was in flight
+	if (!bShouldTraceForItems || !bAsyncItemTrace) return;
+
+	UpdateTraceHitItem(TraceDatum.OutHits.Num() > 0 ? TraceDatum.OutHits[0] : FHitResult());
+}
+
+void AShooterCharacter::UpdateTraceHitItem(const FHitResult& ItemTraceHit)
+{
+	if (ItemTraceHit.bBlockingHit)
+	{
+		TraceHitItem = Cast<AItem>(ItemTraceHit.Actor);
+		auto TraceHitWeapon = Cast<AWeapon>(TraceHitItem);
+		
+		if (TraceHitWeapon)
+		{
+			if (HighlightedSlot == -1)
 			{
-				if (HighlightedSlot == -1)
-				{
-					// Not currently highlighting  a slot: Highlight one
-					HighlightInventorySlot();
-				}
+				// Not currently highlighting  a slot: Highlight one
+				HighlightInventorySlot();
 			}
-			else
+		}
+		else
+		{
+			// Is a slot being highlighted
+			if (HighlightedSlot != -1)
 			{
-				// Is a slot being highlighted
-				if (HighlightedSlot != -1)
-				{
-					// Unhighlight inventory slot
-					UnHighlightInventorySlot();
-				}
+				// Unhighlight inventory slot
+				UnHighlightInventorySlot();
 			}
+		}
 
-			// Wont be able to Spam the SELECT key now
-			if (TraceHitItem && TraceHitItem->GetItemState() == EItemState::EIS_EquipInterping)
+		// Wont be able to Spam the SELECT key now
+		if (TraceHitItem && TraceHitItem->GetItemState() == EItemState::EIS_EquipInterping)
+		{
+			TraceHitItem = nullptr;
+		}
+
+		if (TraceHitItem && TraceHitItem->GetPickupWidget())
+		{
+			TraceHitItem->GetPickupWidget()->SetVisibility(true);
+			TraceHitItem->EnableCustomDepth();
+
+			if (Inventory.Num() >= INVENTORY_CAPACITY)
 			{
-				TraceHitItem = nullptr;
+				// Inventory is full
+				TraceHitItem->SetCharacterInventoryFull(true);
 			}
-
-			if (TraceHitItem && TraceHitItem->GetPickupWidget())
+			else
 			{
-				TraceHitItem->GetPickupWidget()->SetVisibility(true);
-				TraceHitItem->EnableCustomDepth();
-
-				if (Inventory.Num() >= INVENTORY_CAPACITY)
-				{
-					// Inventory is full
-					TraceHitItem->SetCharacterInventoryFull(true);
-				}
-				else
-				{
-					// Inventory has room
-					TraceHitItem->SetCharacterInventoryFull(false);
-				}
-
+				// Inventory has room
+				TraceHitItem->SetCharacterInventoryFull(false);
 			}
 
-			// If we hit an Item last frame
-			if (TraceHitItemLastFrame)
+		}
+
+		// If we hit an Item last frame (async results can outlive it)
+		if (IsValid(TraceHitItemLastFrame))
+		{
+			if (TraceHitItem != TraceHitItemLastFrame)
 			{
-				if (TraceHitItem != TraceHitItemLastFrame)
-				{
-					// We are hitting a different AItem this frame from last
-					// Or AItem is null
-					TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
-					TraceHitItemLastFrame->DisableCustomDepth();
-				}
+				// We are hitting a different AItem this frame from last
+				// Or AItem is null
+				TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
+				TraceHitItemLastFrame->DisableCustomDepth();
 			}
-
-			// Store reference to HitItem next frame
-			TraceHitItemLastFrame = TraceHitItem;
 		}
-	}
-	else if (TraceHitItemLastFrame)
-	{
-		// No longer overlapping any items
-		// Hide the last traced item if its not null
-		TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
-		TraceHitItemLastFrame->DisableCustomDepth();
+
+		// Store reference to HitItem next frame
+		TraceHitItemLastFrame = TraceHitItem;
 	}
 }
 
@@ -1757,8 +1799,8 @@ void AShooterCharacter::EquipWeapon(AWeapon* WeaponToEquip, bool bSwapping)
 		EquippedWeapon = WeaponToEquip;
 		EquippedWeapon->SetItemState(EItemState::EIS_Equipped);
 
-		// Set Noise Range for the Weapon
-		NoiseRangeSphere->SetSphereRadius(EquippedWeapon->GetNoiseRange());
+		// Show the noise range of the Weapon
+		NoiseRangeSphere->SetSphereRadius(GetNoiseLoudness());
 	}
 }
 
@@ -1812,6 +1854,7 @@ void AShooterCharacter::InitializeAmmoMap()
 {
 	AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);
 	AmmoMap.Add(EAmmoType::EAT_AR, StartingARAmmo);
+	AmmoMap.Add(EAmmoType::EAT_Shells, StartingShellAmmo);
 }
 
 bool AShooterCharacter::WeaponHasAmmo()
@@ -1841,7 +1884,14 @@ void AShooterCharacter::SendBullet()
 		//Show muzzle flash
 		if (EquippedWeapon->GetMuzzleFlash())
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EquippedWeapon->GetMuzzleFlash(), SocketTransform);
+			UParticlePoolSubsystem::SpawnEmitterAtLocation(this, EquippedWeapon->GetMuzzleFlash(), SocketTransform);
+		}
+
+		// Shotguns resolve all their pellets in one batch
+		if (EquippedWeapon->GetPelletCount() > 1)
+		{
+			SendPellets(SocketTransform);
+			return;
 		}
 
 		FHitResult BeamHitResult;
@@ -1863,8 +1913,8 @@ void AShooterCharacter::SendBullet()
 					/** Spawn Default Impact Particles */
 					if (ImpactParticles)
 					{
-						UGameplayStatics::SpawnEmitterAtLocation(
-							GetWorld(),
+						UParticlePoolSubsystem::SpawnEmitterAtLocation(
+							this,
 							ImpactParticles,
 							BeamHitResult.Location
 						);
@@ -1875,127 +1925,25 @@ void AShooterCharacter::SendBullet()
 				AEnemy* HitEnemy = Cast<AEnemy>(BeamHitResult.GetActor());
 				if (HitEnemy)
 				{
-					int32 Damage{};
-					int32 CriticalDamage{};
-					int32 MaxAllowedExecutions{};
-					bool bCriticalHit{};
-					bool bExecution = false;
-
-					// Unmark enemy if targets are different
-					if (HitEnemy != MarkedEnemyForExecution)
-					{
-						MarkedEnemyForExecution = nullptr;
-						bLastHeadshotWasACrit = false;
-					}
-
-					// Check Headshots
-					if (BeamHitResult.BoneName.ToString() == HitEnemy->GetHeadBone())
-					{
-						// Apply Headshot dmg						
-						Damage = EquippedWeapon->GetHeadshotDamage() + EquippedWeapon->GetRarityBonusHeadshotDamage();
-						MaxAllowedExecutions = EquippedWeapon->GetRarityMaxChainedExecutions();
-						bCriticalHit = EquippedWeapon->CanCriticalHit();
-						CriticalDamage = EquippedWeapon->GetCriticalHit(bCriticalHit, Damage) + BaseDamageModifier;
-
-						if (!bInChainedExecution && bCriticalHit && !bLastHeadshotWasACrit)
-						{
-							// Mark Enemy for execution
-							bLastHeadshotWasACrit = true;
-							MarkedEnemyForExecution = HitEnemy;
-						}
-						else if (!bInChainedExecution && bLastHeadshotWasACrit && MarkedEnemyForExecution && MarkedEnemyForExecution == HitEnemy)
-						{
-							// Execute enemy
-							bLastHeadshotWasACrit = false;
-							MarkedEnemyForExecution = nullptr;
-							bExecution = true;
-							bInChainedExecution = true;
-							RemainingChainedExecutions = MaxAllowedExecutions;
-							Damage = HitEnemy->GetHealth() + 1;
-							CriticalDamage = Damage;
-						}
-						else if (bInChainedExecution && RemainingChainedExecutions > 0)
-						{
-							Damage = HitEnemy->GetHealth() + 1;
-							CriticalDamage = Damage;
-							RemainingChainedExecutions = (RemainingChainedExecutions - 1) < 0 ? 0 : --RemainingChainedExecutions;
-						}
-						else if (bInChainedExecution && RemainingChainedExecutions <= 0)
-						{
-							bInChainedExecution = false;
-						}
-
-						// Apply Bullet Time
-						if (bCriticalHit || bExecution || bInChainedExecution)
-						{
-							PlayBulletTimeCriticalHitShake(GetActorLocation());
-							ApplyBulletTime(
-								EquippedWeapon->GetRarityBulletTimeModifier(),
-								EquippedWeapon->GetRarityBulletTimeDilation(),
-								bExecution || bInChainedExecution
-							);
-
-							PlayBulletTimeRefraction(BeamHitResult);
-						}
-
-						UGameplayStatics::ApplyDamage(
-							BeamHitResult.GetActor(),
-							CriticalDamage, // For now
-							GetController(),
-							this,
-							(bExecution || bInChainedExecution) ? UMarkedExecutionDamageType::StaticClass() : UDamageType::StaticClass()
-						);
-
-						// Play Marked Execution Sound
-						if (bExecution || bInChainedExecution) PlayMarkedExecutionSound();
-
-						// Show Headshot Hit Numbers
-						HitEnemy->ShowHitNumber(CriticalDamage, BeamHitResult.Location, bCriticalHit ? false : true , bCriticalHit);
-					}
-					else
-					{
-						bLastHeadshotWasACrit = false;
-						bInChainedExecution = false;
-						RemainingChainedExecutions = 0;
-
-						// Apply Bodyshot damage
-						Damage = EquippedWeapon->GetDamage() + EquippedWeapon->GetRarityBonusDamage();
-						bCriticalHit = EquippedWeapon->CanCriticalHit();
-						CriticalDamage = EquippedWeapon->GetCriticalHit(bCriticalHit, Damage) + BaseDamageModifier;
-
-						// Apply Bullet Time
-						if (bCriticalHit)
-						{
-							PlayBulletTimeCriticalHitShake(GetActorLocation());
-							ApplyBulletTime(
-								EquippedWeapon->GetRarityBulletTimeModifier(),
-								EquippedWeapon->GetRarityBulletTimeDilation()
-							);
-
-							PlayBulletTimeRefraction(BeamHitResult);
-						}
-
-						UGameplayStatics::ApplyDamage(
-							BeamHitResult.GetActor(),
-							CriticalDamage, // For now
-							GetController(),
-							this,
-							UDamageType::StaticClass()
-						);
-
-						// Show Hit Numbers
-						HitEnemy->ShowHitNumber(CriticalDamage, BeamHitResult.Location, false, bCriticalHit);
-
-						SetGlobalCombatState();
-					}
+					FShotHitRecord Hit;
+					Hit.TargetId = HitEnemy->GetUniqueID();
+					Hit.TargetHealth = HitEnemy->GetHealth();
+					const FHitZoneInfo HitZone{ HitEnemy->GetHitZone(BeamHitResult.BoneName) };
+					Hit.bHeadshot = HitZone.IsHeadshot();
+					Hit.ZoneMultiplier = HitZone.DamageMultiplier;
+
+					FShotExecutionState ExecutionState{ GetShotExecutionState() };
+					const FShotOutcome Outcome = FShotResolver::ResolveShot(Hit, GetShotWeaponStats(), ExecutionState, ShotRandomStream);
+					SetShotExecutionState(ExecutionState, HitEnemy);
+
+					ApplyShotOutcome(Outcome, HitEnemy, BeamHitResult);
 				}
 			}
 
-
 			if (SmokeBeam)
 			{
-				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
-					GetWorld(),
+				UParticleSystemComponent* Beam = UParticlePoolSubsystem::SpawnEmitterAtLocation(
+					this,
 					SmokeBeam,
 					SocketTransform
 				);
@@ -2009,6 +1957,164 @@ void AShooterCharacter::SendBullet()
 	}
 }
 
+void AShooterCharacter::SendPellets(const FTransform& SocketTransform)
+{
+	const FVector MuzzleLocation{ SocketTransform.GetLocation() };
+
+	// Aim the pellet cone at whatever is under the crosshairs
+	FHitResult CrosshairHitResult;
+	FVector AimLocation;
+	TraceUnderCrosshairs(CrosshairHitResult, AimLocation);
+
+	const FVector AimDirection{ (AimLocation - MuzzleLocation).GetSafeNormal() };
+	const float ConeHalfAngle{ FMath::DegreesToRadians(EquippedWeapon->GetPelletSpread()) };
+	const int32 PelletCount{ EquippedWeapon->GetPelletCount() };
+
+	FHitscanBatch PelletBatch(PelletCount);
+	for (int32 Pellet = 0; Pellet < PelletCount; ++Pellet)
+	{
+		const FVector PelletDirection{ FMath::VRandCone(AimDirection, ConeHalfAngle) };
+		PelletBatch.AddRay(MuzzleLocation, MuzzleLocation + PelletDirection * FCrosshairQueryCache::TraceLength);
+	}
+
+	FCollisionQueryParams PelletQueryParams(SCENE_QUERY_STAT(ShotgunPellets), false, this);
+	PelletBatch.Trace(GetWorld(), PelletQueryParams);
+
+	const TArray<FHitResult>& PelletHits{ PelletBatch.GetRayHits() };
+
+	// Per pellet: only cosmetic FX
+	for (const FHitResult& PelletHit : PelletHits)
+	{
+		if (SmokeBeam)
+		{
+			UParticleSystemComponent* Beam = UParticlePoolSubsystem::SpawnEmitterAtLocation(
+				this,
+				SmokeBeam,
+				SocketTransform
+			);
+
+			if (Beam)
+			{
+				Beam->SetVectorParameter(FName("Target"), PelletHit.Location);
+			}
+		}
+
+		if (PelletHit.bBlockingHit && ImpactParticles && !Cast<IBulletHitInterface>(PelletHit.GetActor()))
+		{
+			UParticlePoolSubsystem::SpawnEmitterAtLocation(
+				this,
+				ImpactParticles,
+				PelletHit.Location
+			);
+		}
+	}
+
+	// Per actor: one BulletHit, one ApplyDamage and one hit number no matter how many pellets landed
+	for (const TPair<AActor*, TArray<int32>>& ActorHit : PelletBatch.GetActorHits())
+	{
+		FHitResult FirstHit{ PelletHits[ActorHit.Value[0]] };
+
+		IBulletHitInterface* BulletHitInterface = Cast<IBulletHitInterface>(ActorHit.Key);
+		if (BulletHitInterface)
+		{
+			BulletHitInterface->BulletHit_Implementation(FirstHit, this, GetController());
+		}
+
+		AEnemy* HitEnemy = Cast<AEnemy>(ActorHit.Key);
+		if (!HitEnemy) continue;
+
+		TArray<FShotHitRecord, TInlineAllocator<16>> PelletRecords;
+		for (int32 PelletIndex : ActorHit.Value)
+		{
+			FShotHitRecord& Pellet = PelletRecords.AddDefaulted_GetRef();
+			Pellet.TargetId = HitEnemy->GetUniqueID();
+			Pellet.TargetHealth = HitEnemy->GetHealth();
+			const FHitZoneInfo HitZone{ HitEnemy->GetHitZone(PelletHits[PelletIndex].BoneName) };
+			Pellet.bHeadshot = HitZone.IsHeadshot();
+			Pellet.ZoneMultiplier = HitZone.DamageMultiplier;
+		}
+
+		FShotExecutionState ExecutionState{ GetShotExecutionState() };
+		const FShotOutcome Outcome = FShotResolver::ResolvePellets(PelletRecords, GetShotWeaponStats(), ExecutionState, ShotRandomStream);
+		SetShotExecutionState(ExecutionState, HitEnemy);
+
+		ApplyShotOutcome(Outcome, HitEnemy, FirstHit);
+	}
+}
+
+FShotWeaponStats AShooterCharacter::GetShotWeaponStats() const
+{
+	FShotWeaponStats Stats;
+	Stats.Damage = EquippedWeapon->GetDamage();
+	Stats.HeadshotDamage = EquippedWeapon->GetHeadshotDamage();
+	Stats.BonusDamage = EquippedWeapon->GetRarityBonusDamage();
+	Stats.BonusHeadshotDamage = EquippedWeapon->GetRarityBonusHeadshotDamage();
+	Stats.CriticalChance = EquippedWeapon->GetRarityCriticalChance();
+	Stats.CriticalMultiplier = EquippedWeapon->GetRarityCriticalMultiplier();
+	Stats.MaxChainedExecutions = EquippedWeapon->GetRarityMaxChainedExecutions();
+	Stats.DamageModifier = BaseDamageModifier;
+	return Stats;
+}
+
+FShotExecutionState AShooterCharacter::GetShotExecutionState() const
+{
+	FShotExecutionState State;
+	State.bLastHeadshotWasACrit = bLastHeadshotWasACrit;
+	State.bInChainedExecution = bInChainedExecution;
+	State.RemainingChainedExecutions = RemainingChainedExecutions;
+	State.MarkedTargetId = MarkedEnemyForExecution ? MarkedEnemyForExecution->GetUniqueID() : 0;
+	return State;
+}
+
+void AShooterCharacter::SetShotExecutionState(const FShotExecutionState& State, AEnemy* HitEnemy)
+{
+	bLastHeadshotWasACrit = State.bLastHeadshotWasACrit;
+	bInChainedExecution = State.bInChainedExecution;
+	RemainingChainedExecutions = State.RemainingChainedExecutions;
+
+	// The resolver only ever marks the enemy it was given
+	if (State.MarkedTargetId == 0)
+	{
+		MarkedEnemyForExecution = nullptr;
+	}
+	else if (HitEnemy && State.MarkedTargetId == HitEnemy->GetUniqueID())
+	{
+		MarkedEnemyForExecution = HitEnemy;
+	}
+}
+
+void AShooterCharacter::ApplyShotOutcome(const FShotOutcome& Outcome, AEnemy* HitEnemy, FHitResult& HitResult)
+{
+	// Apply Bullet Time
+	if (Outcome.bBulletTime)
+	{
+		PlayBulletTimeCriticalHitShake(GetActorLocation());
+		ApplyBulletTime(
+			EquippedWeapon->GetRarityBulletTimeModifier(),
+			EquippedWeapon->GetRarityBulletTimeDilation(),
+			Outcome.bExecutionDamage
+		);
+
+		PlayBulletTimeRefraction(HitResult);
+	}
+
+	UGameplayStatics::ApplyDamage(
+		HitEnemy,
+		Outcome.Damage,
+		GetController(),
+		this,
+		Outcome.bExecutionDamage ? UMarkedExecutionDamageType::StaticClass() : UDamageType::StaticClass()
+	);
+
+	// Play Marked Execution Sound
+	if (Outcome.bExecutionDamage) PlayMarkedExecutionSound();
+
+	// Show Hit Numbers
+	HitEnemy->ShowHitNumber(Outcome.Damage, HitResult.Location, Outcome.bHeadshot && !Outcome.bCriticalHit, Outcome.bCriticalHit);
+
+	if (Outcome.bSetsCombatState) SetGlobalCombatState();
+}
+
 bool AShooterCharacter::GetGlobalCombatState()
 {
 	auto* GameState = Cast<AShooterGameState>(GetWorld()->GetGameState());
@@ -2043,8 +2149,8 @@ void AShooterCharacter::PlayBulletTimeRefraction(FHitResult& BeamHitResult)
 {
 	if (BulletTimeRefraction)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
+		UParticlePoolSubsystem::SpawnEmitterAtLocation(
+			this,
 			BulletTimeRefraction,
 			BeamHitResult.Location
 		);
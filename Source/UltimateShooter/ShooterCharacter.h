@@ -4,8 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "WorldCollision.h"
 #include "AmmoType.h"
 #include "PersistentEffectType.h"
+#include "CrosshairQueryCache.h"
+#include "ShotResolver.h"
 #include "ShooterCharacter.generated.h"
 
 UENUM(BlueprintType)
@@ -134,6 +137,15 @@ protected:
 	/** Trace for items if overlappedItemCount > 0 */
 	void TraceForItems();
 
+	/** Issues the item trace asynchronously, its result is applied one frame later */
+	void StartAsyncItemTrace();
+
+	/** Called by the world when the async item trace has completed */
+	void OnAsyncItemTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Highlights the item under the crosshairs and hides the one from last trace */
+	void UpdateTraceHitItem(const FHitResult& ItemTraceHit);
+
 	/** Spawn the default weapon and attaches it to the mesh */
 	class AWeapon* SpawnDefaultWeapon();
 
@@ -159,6 +171,13 @@ protected:
 	/** FireWeapon functions */
 	void PlayFireSound();
 	void SendBullet();
+	void SendPellets(const FTransform& SocketTransform);
+
+	/** Feed the shot resolver and apply what it decided */
+	FShotWeaponStats GetShotWeaponStats() const;
+	FShotExecutionState GetShotExecutionState() const;
+	void SetShotExecutionState(const FShotExecutionState& State, class AEnemy* HitEnemy);
+	void ApplyShotOutcome(const FShotOutcome& Outcome, AEnemy* HitEnemy, FHitResult& HitResult);
 	bool GetGlobalCombatState();
 	void SetGlobalCombatState();
 	void PlayBulletTimeRefraction(FHitResult& BeamHitResult);
@@ -256,8 +275,6 @@ protected:
 
 	void PlayArmorNegationEmote() const;
 
-	void AlertEnemiesInNoiseRange(TArray<AActor*> EnemiesInRange);
-
 	UFUNCTION()
 	void PlayExplosionSlowMoEmote();
 
@@ -480,6 +497,19 @@ private:
 	/** True if Item Line Tracing to be run every frame */
 	bool bShouldTraceForItems;
 
+	/** Trace for items asynchronously and apply the result a frame later. Turn off to compare with the synchronous trace */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
+		bool bAsyncItemTrace;
+
+	/** Handle of the async item trace in flight, invalid when none is pending */
+	FTraceHandle AsyncItemTraceHandle;
+
+	/** Bound to OnAsyncItemTraceDone in BeginPlay */
+	FTraceDelegate AsyncItemTraceDelegate;
+
+	/** Crosshair trace shared by TraceForItems and GetBeamEndLocation, refreshed at most once per frame */
+	FCrosshairQueryCache CrosshairQueryCache;
+
 	/** No of overlapped items when tracing for items */
 	int8 OverlappedItemCount;
 
@@ -519,6 +549,10 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
 		int32 StartingARAmmo;
 
+	/** Starting amount of Shotgun shells */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
+		int32 StartingShellAmmo;
+
 	/** Current combat state: Can only fire or Reload if UnOccupied */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 		ECombatState CombatState;
@@ -817,6 +851,9 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Executions", meta = (AllowPrivateAccess = "true"))
 		int32 RemainingChainedExecutions;
 
+	/** Crit rolls of the shot resolver */
+	FRandomStream ShotRandomStream;
+
 	FTimerHandle CombatStateResetTimer;
 
 public:
@@ -901,5 +938,9 @@ public:
 	void SetSceneVignette(float Amount, bool bOverride = true);
 	void StartExplosionSlowMoEmote();
 
-	TArray<class AActor*> GetEnemiesInNoiseRange();
+	/** Range shots are heard over: weapon noise range scaled by the level noise modifier */
+	float GetNoiseLoudness() const;
+
+	/** Holds or releases the fire button, for scripted firing */
+	void SetAutoFireHeld(bool bHeld);
 };
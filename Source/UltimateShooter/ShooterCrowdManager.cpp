@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterCrowdManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NavigationSystem.h"
+#include "UltimateShooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Manager Tick"), STAT_CrowdManagerTick, STATGROUP_UltimateShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Agents"), STAT_CrowdAgents, STATGROUP_UltimateShooter);
+
+void UShooterCrowdManager::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CrowdManagerTick);
+	SET_DWORD_STAT(STAT_CrowdAgents, ActiveAgents.Num());
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	Super::Tick(DeltaTime);
+	const double TickSeconds{ FPlatformTime::Seconds() - StartTime };
+
+	TotalTickSeconds += TickSeconds;
+	MaxTickSeconds = FMath::Max(MaxTickSeconds, TickSeconds);
+	++NumTicks;
+}
+
+void UShooterCrowdManager::LogStats()
+{
+	UE_LOG(LogTemp, Display, TEXT("Crowd: %d agents, %.3f ms average, %.3f ms max over %d frames"),
+		ActiveAgents.Num(),
+		NumTicks > 0 ? TotalTickSeconds * 1000.0 / NumTicks : 0.0,
+		MaxTickSeconds * 1000.0,
+		NumTicks);
+
+	TotalTickSeconds = 0.0;
+	MaxTickSeconds = 0.0;
+	NumTicks = 0;
+}
+
+static FAutoConsoleCommandWithWorld CrowdStatsCommand(
+	TEXT("us.AI.CrowdStats"),
+	TEXT("Logs the crowd manager time per frame since the last call"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+		UShooterCrowdManager* CrowdManager = NavSys ? Cast<UShooterCrowdManager>(NavSys->GetCrowdManager()) : nullptr;
+		if (!CrowdManager)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Crowd: CrowdManagerClass is not ShooterCrowdManager"));
+			return;
+		}
+		CrowdManager->LogStats();
+	})
+);
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Navigation/CrowdManager.h"
+#include "ShooterCrowdManager.generated.h"
+
+/**
+ * Detour crowd manager that reports its cost: the simulation time per frame and the number of agents
+ * show in stat UltimateShooter, us.AI.CrowdStats logs a running average.
+ * Set as CrowdManagerClass of the navigation system in DefaultEngine.ini.
+ */
+UCLASS()
+class ULTIMATESHOOTER_API UShooterCrowdManager : public UCrowdManager
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Logs and resets the averages since the last call */
+	void LogStats();
+
+	FORCEINLINE int32 GetNumAgents() const { return ActiveAgents.Num(); }
+
+	/** Tick time since the last LogStats */
+	FORCEINLINE double GetTotalTickSeconds() const { return TotalTickSeconds; }
+
+private:
+
+	double TotalTickSeconds = 0.0;
+	double MaxTickSeconds = 0.0;
+	int32 NumTicks = 0;
+};
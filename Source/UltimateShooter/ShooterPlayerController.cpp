@@ -3,8 +3,10 @@
 
 #include "ShooterPlayerController.h"
 #include "Blueprint/UserWidget.h"
+#include "HitNumberSubsystem.h"
 
-AShooterPlayerController::AShooterPlayerController()
+AShooterPlayerController::AShooterPlayerController() :
+	HitNumberPoolSize(32)
 {
 
 }
@@ -25,4 +27,12 @@ void AShooterPlayerController::BeginPlay()
 			HUDOverlay->SetVisibility(ESlateVisibility::Visible);
 		}
 	}
+
+	if (HitNumberWidgetClass && IsLocalController())
+	{
+		if (UHitNumberSubsystem* HitNumbers = UHitNumberSubsystem::Get(this))
+		{
+			HitNumbers->InitializePool(this, HitNumberWidgetClass, HitNumberPoolSize);
+		}
+	}
 }
@@ -29,4 +29,12 @@ private:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Widgets, meta = (AllowPrivateAccess = "true"))
 	class UUserWidget* HUDOverlay;
+
+	/** Widget class of the pooled hit numbers, enemies create their own when not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Widgets, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<UUserWidget> HitNumberWidgetClass;
+
+	/** Hit numbers that can be on screen at once before the oldest is reused */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Widgets, meta = (AllowPrivateAccess = "true"))
+	int32 HitNumberPoolSize;
 };
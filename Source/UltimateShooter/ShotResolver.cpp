@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShotResolver.h"
+#include "HAL/IConsoleManager.h"
+
+FShotOutcome FShotResolver::ResolveShot(const FShotHitRecord& Hit, const FShotWeaponStats& Stats, FShotExecutionState& State, FRandomStream& Random)
+{
+	FShotOutcome Outcome;
+
+	// Unmark enemy if targets are different
+	if (Hit.TargetId != State.MarkedTargetId)
+	{
+		State.MarkedTargetId = 0;
+		State.bLastHeadshotWasACrit = false;
+	}
+
+	if (Hit.bHeadshot)
+	{
+		const int32 Damage = (Stats.HeadshotDamage + Stats.BonusHeadshotDamage) * Hit.ZoneMultiplier;
+		Outcome.bCriticalHit = RollCriticalHit(Stats, Random);
+		Outcome.Damage = ApplyCriticalHit(Outcome.bCriticalHit, Damage, Stats, Random) + Stats.DamageModifier;
+		Outcome.bHeadshot = true;
+
+		bool bExecution{ false };
+
+		if (!State.bInChainedExecution && Outcome.bCriticalHit && !State.bLastHeadshotWasACrit)
+		{
+			// Mark Enemy for execution
+			State.bLastHeadshotWasACrit = true;
+			State.MarkedTargetId = Hit.TargetId;
+		}
+		else if (!State.bInChainedExecution && State.bLastHeadshotWasACrit && State.MarkedTargetId != 0 && State.MarkedTargetId == Hit.TargetId)
+		{
+			// Execute enemy
+			State.bLastHeadshotWasACrit = false;
+			State.MarkedTargetId = 0;
+			bExecution = true;
+			State.bInChainedExecution = true;
+			State.RemainingChainedExecutions = Stats.MaxChainedExecutions;
+			Outcome.Damage = Hit.TargetHealth + 1;
+		}
+		else if (State.bInChainedExecution && State.RemainingChainedExecutions > 0)
+		{
+			Outcome.Damage = Hit.TargetHealth + 1;
+			--State.RemainingChainedExecutions;
+		}
+		else if (State.bInChainedExecution && State.RemainingChainedExecutions <= 0)
+		{
+			State.bInChainedExecution = false;
+		}
+
+		Outcome.bExecutionDamage = bExecution || State.bInChainedExecution;
+		Outcome.bBulletTime = Outcome.bCriticalHit || Outcome.bExecutionDamage;
+	}
+	else
+	{
+		State.bLastHeadshotWasACrit = false;
+		State.bInChainedExecution = false;
+		State.RemainingChainedExecutions = 0;
+
+		// Bodyshot damage
+		const int32 Damage = (Stats.Damage + Stats.BonusDamage) * Hit.ZoneMultiplier;
+		Outcome.bCriticalHit = RollCriticalHit(Stats, Random);
+		Outcome.Damage = ApplyCriticalHit(Outcome.bCriticalHit, Damage, Stats, Random) + Stats.DamageModifier;
+		Outcome.bBulletTime = Outcome.bCriticalHit;
+		Outcome.bSetsCombatState = true;
+	}
+
+	return Outcome;
+}
+
+FShotOutcome FShotResolver::ResolvePellets(TArrayView<const FShotHitRecord> PelletHits, const FShotWeaponStats& Stats, FShotExecutionState& State, FRandomStream& Random)
+{
+	FShotOutcome Outcome;
+
+	// Pellets never mark or chain executions
+	State = FShotExecutionState();
+
+	float Damage{};
+	for (const FShotHitRecord& Pellet : PelletHits)
+	{
+		if (Pellet.bHeadshot)
+		{
+			Damage += (Stats.HeadshotDamage + Stats.BonusHeadshotDamage) * Pellet.ZoneMultiplier;
+			Outcome.bHeadshot = true;
+		}
+		else
+		{
+			Damage += (Stats.Damage + Stats.BonusDamage) * Pellet.ZoneMultiplier;
+		}
+	}
+
+	Outcome.bCriticalHit = RollCriticalHit(Stats, Random);
+	Outcome.Damage = ApplyCriticalHit(Outcome.bCriticalHit, Damage, Stats, Random) + Stats.DamageModifier;
+	Outcome.bBulletTime = Outcome.bCriticalHit;
+	Outcome.bSetsCombatState = true;
+
+	return Outcome;
+}
+
+bool FShotResolver::RollCriticalHit(const FShotWeaponStats& Stats, FRandomStream& Random)
+{
+	const float ChanceRange{ Random.FRandRange(0.f, 100.f) };
+	return ChanceRange + Stats.CriticalChance > 100.f;
+}
+
+float FShotResolver::ApplyCriticalHit(bool bCriticalHit, float NoCritDamage, const FShotWeaponStats& Stats, FRandomStream& Random)
+{
+	if (!bCriticalHit) return NoCritDamage;
+
+	return NoCritDamage * Random.FRandRange(1.f, Stats.CriticalMultiplier * 1.0f);
+}
+
+static void BenchmarkShotResolver(const TArray<FString>& Args)
+{
+	const int32 NumShots{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10'000'000 };
+	if (NumShots <= 0) return;
+
+	FRandomStream Random(1337);
+
+	FShotWeaponStats Stats;
+	Stats.Damage = 20.f;
+	Stats.HeadshotDamage = 45.f;
+	Stats.BonusDamage = 5.f;
+	Stats.BonusHeadshotDamage = 10.f;
+	Stats.CriticalChance = 20;
+	Stats.CriticalMultiplier = 3;
+	Stats.MaxChainedExecutions = 3;
+
+	// A fixed spread of targets and headshots, cycled through by the timed loop
+	constexpr int32 NumRecords{ 1024 };
+	TArray<FShotHitRecord> Records;
+	Records.Reserve(NumRecords);
+	for (int32 Index = 0; Index < NumRecords; ++Index)
+	{
+		FShotHitRecord& Record = Records.AddDefaulted_GetRef();
+		Record.TargetId = 1 + Random.RandHelper(4);
+		Record.TargetHealth = Random.FRandRange(50.f, 300.f);
+		Record.bHeadshot = Random.FRand() < 0.4f;
+	}
+
+	FShotExecutionState State;
+	int64 TotalDamage{};
+	int32 NumExecutions{};
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	for (int32 Shot = 0; Shot < NumShots; ++Shot)
+	{
+		const FShotOutcome Outcome = FShotResolver::ResolveShot(Records[Shot & (NumRecords - 1)], Stats, State, Random);
+		TotalDamage += Outcome.Damage;
+		NumExecutions += Outcome.bExecutionDamage ? 1 : 0;
+	}
+	const double Elapsed{ FPlatformTime::Seconds() - StartTime };
+
+	UE_LOG(LogTemp, Display, TEXT("ShotResolver: %d shots in %.3f ms, %.2f million shots/s (total damage %lld, %d execution shots)"),
+		NumShots,
+		Elapsed * 1000.0,
+		Elapsed > 0.0 ? NumShots / Elapsed / 1'000'000.0 : 0.0,
+		TotalDamage,
+		NumExecutions);
+}
+
+static FAutoConsoleCommand BenchmarkShotResolverCommand(
+	TEXT("us.Bench.ShotResolver"),
+	TEXT("Resolves N shots (default 10 million) through FShotResolver and logs shots resolved per second"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkShotResolver)
+);
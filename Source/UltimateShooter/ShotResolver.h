@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Weapon and shooter numbers the resolver needs, copied out once per shot */
+struct FShotWeaponStats
+{
+	float Damage = 0.f;
+	float HeadshotDamage = 0.f;
+	float BonusDamage = 0.f;
+	float BonusHeadshotDamage = 0.f;
+
+	/** 0-100, added to a 0-100 roll: a crit happens above 100 */
+	int32 CriticalChance = 0;
+	int32 CriticalMultiplier = 1;
+
+	int32 MaxChainedExecutions = 0;
+
+	/** Flat damage added on top of every shot by the shooter */
+	float DamageModifier = 0.f;
+};
+
+/** What a single ray hit */
+struct FShotHitRecord
+{
+	/** Unique id of the target, compared against the target marked for execution. 0 is no target */
+	uint32 TargetId = 0;
+
+	float TargetHealth = 0.f;
+
+	/** Head or weak point: headshot damage, can mark and execute */
+	bool bHeadshot = false;
+
+	/** Damage multiplier of the hit zone */
+	float ZoneMultiplier = 1.f;
+};
+
+/** Headshot crit / marked execution / chained execution state carried from shot to shot */
+struct FShotExecutionState
+{
+	bool bLastHeadshotWasACrit = false;
+	bool bInChainedExecution = false;
+	int32 RemainingChainedExecutions = 0;
+
+	/** TargetId of the enemy marked by the last headshot crit, 0 when none */
+	uint32 MarkedTargetId = 0;
+};
+
+/** Damage and side effects of a resolved shot */
+struct FShotOutcome
+{
+	int32 Damage = 0;
+
+	bool bCriticalHit = false;
+
+	/** Shot was the execution itself or part of a chain: kills outright with the marked execution damage type */
+	bool bExecutionDamage = false;
+
+	bool bHeadshot = false;
+
+	/** Shot should trigger bullet time, shake and refraction */
+	bool bBulletTime = false;
+
+	/** Shot puts the level in combat: single shots only when they hit the body, shotgun blasts always */
+	bool bSetsCombatState = false;
+};
+
+/**
+ * The damage and execution rules of SendBullet, on plain data only.
+ * No UObject access, so it can be run in isolation and benchmarked with 'us.Bench.ShotResolver'.
+ */
+struct FShotResolver
+{
+	/** Resolves one bullet and advances the execution state */
+	static FShotOutcome ResolveShot(const FShotHitRecord& Hit, const FShotWeaponStats& Stats, FShotExecutionState& State, FRandomStream& Random);
+
+	/** Resolves every pellet that hit the same target as one outcome. Pellets reset the execution state */
+	static FShotOutcome ResolvePellets(TArrayView<const FShotHitRecord> PelletHits, const FShotWeaponStats& Stats, FShotExecutionState& State, FRandomStream& Random);
+
+	static bool RollCriticalHit(const FShotWeaponStats& Stats, FRandomStream& Random);
+
+	static float ApplyCriticalHit(bool bCriticalHit, float NoCritDamage, const FShotWeaponStats& Stats, FRandomStream& Random);
+};
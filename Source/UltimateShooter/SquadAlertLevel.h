@@ -0,0 +1,10 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class ESquadAlertLevel : uint8
+{
+	ESAL_Idle UMETA(DisplayName = "Idle"),
+	ESAL_Alerted UMETA(DisplayName = "Alerted"),
+
+	ESAL_MAX UMETA(DisplayName = "DefaultMAX")
+};
\ No newline at end of file
@@ -9,3 +9,5 @@
 #define EPS_Tile EPhysicalSurface::SurfaceType3
 #define EPS_Grass EPhysicalSurface::SurfaceType4
 #define EPS_Water EPhysicalSurface::SurfaceType5
+
+DECLARE_STATS_GROUP(TEXT("UltimateShooter"), STATGROUP_UltimateShooter, STATCAT_Advanced);
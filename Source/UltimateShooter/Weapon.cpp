@@ -3,6 +3,12 @@
 
 #include "Weapon.h"
 #include "Components/SphereComponent.h"
+#include "ItemDataRegistry.h"
+#include "Engine/StreamableManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+// Yaw rate in degrees per second the material spins the mesh by, 0 stops it
+static const FName SpinRateParam{ TEXT("Spin Rate") };
 
 AWeapon::AWeapon() :
 	ThrowWeaponTime(0.7f),
@@ -17,8 +23,13 @@ AWeapon::AWeapon() :
 	SlideDisplacementTime(0.3f),
 	bMovingSlide(false),
 	MaxSlideDisplacement(6.0f),
+	PickupSpinRate(45.f),
+	bMaterialDrivesSpin(false),
+	bInventoryAssetsApplied(false),
 	MaxRecoilRotation(20.f),
-	bAutomatic(true)
+	bAutomatic(true),
+	PelletCount(1),
+	PelletSpread(0.f)
 {
 	// This is a must for tick to work!
 	PrimaryActorTick.bCanEverTick = true;
@@ -38,7 +49,10 @@ void AWeapon::Tick(float DeltaTime)
 	// Update Slide on Pistol
 	UpdateSlideDisplacement();
 
-	RotateWhenOnPickup();
+	if (!bMaterialDrivesSpin)
+	{
+		RotateWhenOnPickup(DeltaTime);
+	}
 }
 
 void AWeapon::ThrowWeapon()
@@ -70,6 +84,7 @@ void AWeapon::ThrowWeapon()
 	bFalling = true;
 	// Start the timer
 	GetWorldTimerManager().SetTimer(ThrowWeaponTimer, this, &AWeapon::StopFalling, ThrowWeaponTime);
+	UpdateTickEnabled();
 
 	EnableGlowMaterial(); // Enable Glow after throwing down
 }
@@ -96,6 +111,7 @@ void AWeapon::StartSlideTimer()
 {
 	bMovingSlide = true;
 	GetWorldTimerManager().SetTimer(SlideTimer, this, &AWeapon::FinishMovingSlide, SlideDisplacementTime);
+	UpdateTickEnabled();
 }
 
 bool AWeapon::ClipIsFull()
@@ -106,139 +122,240 @@ bool AWeapon::ClipIsFull()
 void AWeapon::StopFalling()
 {
 	bFalling = false;
-	// Set the weapon state to Pickup (Ready to pickup)
+	// Set the weapon state to Pickup (Ready to pickup). Starts the Glow Pulsing again
 	SetItemState(EItemState::EIS_Pickup);
-	// Enable Glow Pulsing after throwing down the weapon
-	StartPulseTimer();
 }
 
 void AWeapon::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
 
-	const FString WeaponTablePath{ TEXT("DataTable'/Game/_Game/DataTables/DT_Weapon.DT_Weapon'") };
-	UDataTable* WeaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
+	// Weapon and rarity bonus data come from the preloaded Data Tables
+	const UItemDataRegistry* ItemDataRegistry = UItemDataRegistry::Get(this);
 
-	const FString RarityBonusTablePath{ TEXT("DataTable'/Game/_Game/DataTables/DT_RarityBonusProps.DT_RarityBonusProps'") };
-	UDataTable* RarityBonusTableObject = Cast < UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *RarityBonusTablePath));
+	if (const FWeaponDataTable* WeaponDataRow = ItemDataRegistry->GetWeaponRow(WeaponType))
+	{
+		AmmoType = WeaponDataRow->AmmoType;
+		Ammo = WeaponDataRow->WeaponAmmo;
+		MagazineCapacity = WeaponDataRow->MagazineCapacity;
+		SetItemName(WeaponDataRow->ItemName);
+		SetClipBoneName(WeaponDataRow->ClipBoneName);
+		SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
+		AutoFireRate = WeaponDataRow->AutoFireRate;
+		BoneToHide = WeaponDataRow->BoneToHide;
+		bAutomatic = WeaponDataRow->bAutomatic;
+		Damage = WeaponDataRow->Damage;
+		HeadshotDamage = WeaponDataRow->HeadshotDamage;
+		NoiseRange = WeaponDataRow->NoiseRange;
+		PelletCount = WeaponDataRow->PelletCount;
+		PelletSpread = WeaponDataRow->PelletSpread;
+	}
 
-	if (WeaponTableObject)
+	// Inventory assets stream in once the player comes near, placed weapons don't save them with the level
+	SetEquipSound(nullptr);
+	SetIconItem(nullptr);
+	SetAmmoIcon(nullptr);
+	CrosshairsMiddle = nullptr;
+	CrosshairsTop = nullptr;
+	CrosshairsBottom = nullptr;
+	CrosshairsLeft = nullptr;
+	CrosshairsRight = nullptr;
+	MuzzleFlash = nullptr;
+	FireSound = nullptr;
+	bInventoryAssetsApplied = false;
+
+	RequestDisplayAssets();
+
+	if (const FRarityBasedPropsTable* RarityBonusPropsRow = ItemDataRegistry->GetRarityBonusRow(GetItemRarity()))
 	{
-		FWeaponDataTable* WeaponDataRow = nullptr;
+		RarityBonusDamage = RarityBonusPropsRow->BonusDamage;
+		RarityBonusHeadshotDamage = RarityBonusPropsRow->BonusHeadshotDamage;
+		RarityCriticalChance = RarityBonusPropsRow->CriticalChance;
+		RarityCriticalMultiplier = RarityBonusPropsRow->CriticalDamageMultiplier;
+		RarityBulletTimeModifier = RarityBonusPropsRow->BulletTimeModifier;
+		RarityBulletTimeDilation = RarityBonusPropsRow->BulletTimeDilation;
+		RarityBulletTimeResetMoveSpeed = RarityBonusPropsRow->BulletTimeResetMoveSpeed;
+		RarityMaxChainedExecutions = RarityBonusPropsRow->MaxChainedExecutions;
+	}
 
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_SubmachineGun:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("SubmachineGun"), TEXT(""));
-			break;
+}
 
-		case EWeaponType::EWT_AssaultRifle:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("AssaultRifle"), TEXT(""));
-			break;
+void AWeapon::BeginPlay()
+{
+	Super::BeginPlay();
 
-		case EWeaponType::EWT_Pistol:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("Pistol"), TEXT(""));
-			break;
-		}
+	if (BoneToHide != FName(""))
+	{
+		GetItemMesh()->HideBoneByName(BoneToHide, EPhysBodyOp::PBO_None);
+	}
+}
 
-		if (WeaponDataRow)
-		{
-			AmmoType = WeaponDataRow->AmmoType;
-			Ammo = WeaponDataRow->WeaponAmmo;
-			MagazineCapacity = WeaponDataRow->MagazineCapacity;
-			SetPickupSound(WeaponDataRow->PickupSound);
-			SetEquipSound(WeaponDataRow->EquipSound);
-			GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh);
-			SetItemName(WeaponDataRow->ItemName);
-			SetIconItem(WeaponDataRow->InventoryIcon);
-			SetAmmoIcon(WeaponDataRow->AmmoIcon);
-
-			SetMaterialInstance(WeaponDataRow->MaterialInstance);
-			PreviousMaterialIndex = GetMaterialIndex(); // Store prev Material Index
-			GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr); // Clear Material
-			SetMaterialIndex(WeaponDataRow->MaterialIndex);
-			SetClipBoneName(WeaponDataRow->ClipBoneName);
-			SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
-			GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP);
-			CrosshairsMiddle = WeaponDataRow->CrosshairsMiddle;
-			CrosshairsTop = WeaponDataRow->CrosshairsTop;
-			CrosshairsBottom = WeaponDataRow->CrosshairsBottom;
-			CrosshairsLeft = WeaponDataRow->CrosshairsLeft;
-			CrosshairsRight = WeaponDataRow->CrosshairsRight;
-			AutoFireRate = WeaponDataRow->AutoFireRate;
-			MuzzleFlash = WeaponDataRow->MuzzleFlash;
-			FireSound = WeaponDataRow->FireSound;
-			BoneToHide = WeaponDataRow->BoneToHide;
-			bAutomatic = WeaponDataRow->bAutomatic;
-			Damage = WeaponDataRow->Damage;
-			HeadshotDamage = WeaponDataRow->HeadshotDamage;
-			NoiseRange = WeaponDataRow->NoiseRange;
-		}
+void AWeapon::SetItemProperties(EItemState State)
+{
+	Super::SetItemProperties(State);
 
-		if (GetMaterialInstance())
-		{
-			SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
-			GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("Fresnel Color"), GetGlowColor());
-			GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
-			EnableGlowMaterial();
-		}
+	// Equipped straight away, like the default weapon, without coming near the player first
+	if (State == EItemState::EIS_Equipped || State == EItemState::EIS_PickedUp)
+	{
+		LoadInventoryAssets();
+	}
+
+	UpdateSpin();
+}
+
+bool AWeapon::NeedsTick() const
+{
+	const bool bNeedsSpinTick{ GetItemState() == EItemState::EIS_Pickup && !bMaterialDrivesSpin };
+	return Super::NeedsTick() || bFalling || bMovingSlide || bNeedsSpinTick;
+}
+
+void AWeapon::RefreshMaterialEffects()
+{
+	bMaterialDrivesSpin = MaterialHasParameter(SpinRateParam);
+	UpdateSpin();
+
+	Super::RefreshMaterialEffects();
+}
+
+void AWeapon::UpdateSpin()
+{
+	if (bMaterialDrivesSpin && GetDynamicMaterialInstance())
+	{
+		GetDynamicMaterialInstance()->SetScalarParameterValue(SpinRateParam, GetItemState() == EItemState::EIS_Pickup ? PickupSpinRate : 0.f);
+	}
+}
+
+void AWeapon::RequestDisplayAssets()
+{
+	UItemDataRegistry* ItemDataRegistry = UItemDataRegistry::Get(this);
+
+	const UWorld* World = GetWorld();
+	if (!World || !World->IsGameWorld())
+	{
+		// The editor shows the weapon as soon as it is placed
+		ItemDataRegistry->LoadWeaponAssets(WeaponType, EWeaponAssetGroup::Display);
+		ApplyDisplayAssets();
+		return;
 	}
 
-	if (RarityBonusTableObject)
+	DisplayAssetsHandle = ItemDataRegistry->RequestWeaponAssets(
+		WeaponType,
+		EWeaponAssetGroup::Display,
+		FStreamableDelegate::CreateUObject(this, &AWeapon::ApplyDisplayAssets),
+		FStreamableManager::AsyncLoadHighPriority
+	);
+}
+
+void AWeapon::ApplyDisplayAssets()
+{
+	DisplayAssetsHandle.Reset();
+
+	const FWeaponDataTable* WeaponDataRow = UItemDataRegistry::Get(this)->GetWeaponRow(WeaponType);
+	if (!WeaponDataRow) return;
+
+	SetPickupSound(WeaponDataRow->PickupSound.Get());
+	GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh.Get());
+
+	SetMaterialInstance(WeaponDataRow->MaterialInstance.Get());
+	PreviousMaterialIndex = GetMaterialIndex(); // Store prev Material Index
+	GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr); // Clear Material
+	SetMaterialIndex(WeaponDataRow->MaterialIndex);
+	GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP.Get());
+
+	if (GetMaterialInstance())
 	{
-		FRarityBasedPropsTable* RarityBonusPropsRow = nullptr;
+		SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
+		GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("Fresnel Color"), GetGlowColor());
+		GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
 
-		switch (GetItemRarity())
+		// Only weapons in the world glow, the assets can arrive after the weapon is picked up
+		if (GetItemState() == EItemState::EIS_Equipped || GetItemState() == EItemState::EIS_PickedUp)
 		{
-			case EItemRarity::EWR_Damaged:
-				RarityBonusPropsRow = RarityBonusTableObject->FindRow<FRarityBasedPropsTable>(FName("Damaged"), TEXT(""));
-			break;
-
-			case EItemRarity::EWR_Common:
-				RarityBonusPropsRow = RarityBonusTableObject->FindRow<FRarityBasedPropsTable>(FName("Common"), TEXT(""));
-				break;
-
-			case EItemRarity::EWR_Uncommon:
-				RarityBonusPropsRow = RarityBonusTableObject->FindRow<FRarityBasedPropsTable>(FName("Uncommon"), TEXT(""));
-				break;
-
-			case EItemRarity::EWR_Rare:
-				RarityBonusPropsRow = RarityBonusTableObject->FindRow<FRarityBasedPropsTable>(FName("Rare"), TEXT(""));
-				break;
-				
-			case EItemRarity::EWR_Legendary:
-				RarityBonusPropsRow = RarityBonusTableObject->FindRow<FRarityBasedPropsTable>(FName("Legendary"), TEXT(""));
-				break;
+			DisableGlowMaterial();
+		}
+		else
+		{
+			EnableGlowMaterial();
 		}
+	}
 
-		if (RarityBonusPropsRow)
+	// Streamed in after BeginPlay, so redo what it did with the mesh and the material
+	if (HasActorBegunPlay())
+	{
+		if (BoneToHide != FName(""))
 		{
-			RarityBonusDamage = RarityBonusPropsRow->BonusDamage;
-			RarityBonusHeadshotDamage = RarityBonusPropsRow->BonusHeadshotDamage;
-			RarityCriticalChance = RarityBonusPropsRow->CriticalChance;
-			RarityCriticalMultiplier = RarityBonusPropsRow->CriticalDamageMultiplier;
-			RarityBulletTimeModifier = RarityBonusPropsRow->BulletTimeModifier;
-			RarityBulletTimeDilation = RarityBonusPropsRow->BulletTimeDilation;
-			RarityBulletTimeResetMoveSpeed = RarityBonusPropsRow->BulletTimeResetMoveSpeed;
-			RarityMaxChainedExecutions = RarityBonusPropsRow->MaxChainedExecutions;
+			GetItemMesh()->HideBoneByName(BoneToHide, EPhysBodyOp::PBO_None);
 		}
+		RefreshMaterialEffects();
 	}
+}
 
+void AWeapon::PrefetchInventoryAssets()
+{
+	if (bInventoryAssetsApplied || InventoryAssetsHandle.IsValid()) return;
+
+	InventoryAssetsHandle = UItemDataRegistry::Get(this)->RequestWeaponAssets(
+		WeaponType,
+		EWeaponAssetGroup::Inventory,
+		FStreamableDelegate::CreateUObject(this, &AWeapon::ApplyInventoryAssets)
+	);
 }
 
-void AWeapon::BeginPlay()
+void AWeapon::LoadInventoryAssets()
 {
-	Super::BeginPlay();
+	UItemDataRegistry* ItemDataRegistry = UItemDataRegistry::Get(this);
 
-	if (BoneToHide != FName(""))
+	// Loaded here instead, the pending handles would apply the assets a second time
+	if (DisplayAssetsHandle.IsValid())
 	{
-		GetItemMesh()->HideBoneByName(BoneToHide, EPhysBodyOp::PBO_None);
+		DisplayAssetsHandle->CancelHandle();
+		ItemDataRegistry->LoadWeaponAssets(WeaponType, EWeaponAssetGroup::Display);
+		ApplyDisplayAssets();
+	}
+
+	if (!bInventoryAssetsApplied)
+	{
+		if (InventoryAssetsHandle.IsValid())
+		{
+			InventoryAssetsHandle->CancelHandle();
+		}
+		ItemDataRegistry->LoadWeaponAssets(WeaponType, EWeaponAssetGroup::Inventory);
+		ApplyInventoryAssets();
 	}
 }
 
+void AWeapon::ApplyInventoryAssets()
+{
+	InventoryAssetsHandle.Reset();
+
+	const FWeaponDataTable* WeaponDataRow = UItemDataRegistry::Get(this)->GetWeaponRow(WeaponType);
+	if (!WeaponDataRow) return;
+
+	SetEquipSound(WeaponDataRow->EquipSound.Get());
+	SetIconItem(WeaponDataRow->InventoryIcon.Get());
+	SetAmmoIcon(WeaponDataRow->AmmoIcon.Get());
+	CrosshairsMiddle = WeaponDataRow->CrosshairsMiddle.Get();
+	CrosshairsTop = WeaponDataRow->CrosshairsTop.Get();
+	CrosshairsBottom = WeaponDataRow->CrosshairsBottom.Get();
+	CrosshairsLeft = WeaponDataRow->CrosshairsLeft.Get();
+	CrosshairsRight = WeaponDataRow->CrosshairsRight.Get();
+	MuzzleFlash = WeaponDataRow->MuzzleFlash.Get();
+	FireSound = WeaponDataRow->FireSound.Get();
+	bInventoryAssetsApplied = true;
+}
+
 void AWeapon::FinishMovingSlide()
 {
+	// Settle on the end of the curve, the last tick can land short of it
+	if (SlideDisplacementCurve)
+	{
+		const float CurveValue{ SlideDisplacementCurve->GetFloatValue(SlideDisplacementTime) };
+		SlideDisplacement = CurveValue * MaxSlideDisplacement;
+		RecoilRotation = CurveValue * MaxRecoilRotation;
+	}
+
 	bMovingSlide = false;
+	UpdateTickEnabled();
 }
 
 void AWeapon::UpdateSlideDisplacement()
@@ -252,34 +369,14 @@ void AWeapon::UpdateSlideDisplacement()
 	}
 }
 
-void AWeapon::RotateWhenOnPickup()
+void AWeapon::RotateWhenOnPickup(float DeltaTime)
 {
 	if (GetItemState() == EItemState::EIS_Pickup)
 	{
 		const FRotator CurrentRotation{ GetActorRotation() };
-		const float NewYaw = CurrentRotation.Yaw + 0.75f;
+		const float NewYaw = CurrentRotation.Yaw + PickupSpinRate * DeltaTime;
 		const FRotator NewRotation{ 0.f, NewYaw , 0.f };
 
 		SetActorRotation(NewRotation, ETeleportType::None);
 	}
 }
-
-bool AWeapon::CanCriticalHit()
-{
-	float ChanceRange = FMath::RandRange(0.f, 100.f);
-	bool CanCrit = (ChanceRange + RarityCriticalChance > 100.f) ? true : false;
-
-	return CanCrit;
-}
-
-float AWeapon::GetCriticalHit(bool bCanCriticalHit, float NoCritDamage)
-{
-	if (bCanCriticalHit)
-	{
-		float CritMultiplier = FMath::RandRange(1.f, RarityCriticalMultiplier * 1.0f);
-		float CritDamage = NoCritDamage * FMath::RandRange(1.f, RarityCriticalMultiplier * 1.0f);
-		
-		return CritDamage;
-	}
-	else return NoCritDamage;
-}
@@ -9,11 +9,12 @@
 #include "WeaponType.h"
 #include "Weapon.generated.h"
 
+struct FStreamableHandle;
+
 /**
- * 
+ * Asset references are soft, so loading the table doesn't load every weapon's assets.
+ * UItemDataRegistry streams them in when a weapon needs them.
  */
-
-
 USTRUCT(BlueprintType)
 struct FWeaponDataTable : public FTableRowBase
 {
@@ -29,25 +30,25 @@ struct FWeaponDataTable : public FTableRowBase
 	int32 MagazineCapacity;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class USoundCue* PickupSound;
+	TSoftObjectPtr<class USoundCue> PickupSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class USoundCue* EquipSound;
+	TSoftObjectPtr<USoundCue> EquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class USkeletalMesh* ItemMesh;
+	TSoftObjectPtr<class USkeletalMesh> ItemMesh;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FString ItemName;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class UTexture2D* InventoryIcon;
+	TSoftObjectPtr<class UTexture2D> InventoryIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* AmmoIcon;
+	TSoftObjectPtr<UTexture2D> AmmoIcon;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UMaterialInstance* MaterialInstance;
+	TSoftObjectPtr<UMaterialInstance> MaterialInstance;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 MaterialIndex;
@@ -59,31 +60,31 @@ struct FWeaponDataTable : public FTableRowBase
 	FName ReloadMontageSection;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<UAnimInstance> AnimBP;
+	TSoftClassPtr<UAnimInstance> AnimBP;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsMiddle;
+	TSoftObjectPtr<UTexture2D> CrosshairsMiddle;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsLeft;
+	TSoftObjectPtr<UTexture2D> CrosshairsLeft;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsRight;
+	TSoftObjectPtr<UTexture2D> CrosshairsRight;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsBottom;
+	TSoftObjectPtr<UTexture2D> CrosshairsBottom;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* CrosshairsTop;
+	TSoftObjectPtr<UTexture2D> CrosshairsTop;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float AutoFireRate;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class UParticleSystem* MuzzleFlash;
+	TSoftObjectPtr<class UParticleSystem> MuzzleFlash;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* FireSound;
+	TSoftObjectPtr<USoundCue> FireSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName BoneToHide;
@@ -99,6 +100,14 @@ struct FWeaponDataTable : public FTableRowBase
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float NoiseRange;
+
+	/** Rays fired per shot, more than one makes the weapon fire a batch of pellets */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	int32 PelletCount = 1;
+
+	/** Half angle of the pellet cone in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "45"))
+	float PelletSpread = 0.f;
 };
 
 USTRUCT(BlueprintType)
@@ -149,11 +158,33 @@ protected:
 
 	virtual void BeginPlay() override;
 
+	/** Starts and stops the material spin for the Pickup state */
+	virtual void SetItemProperties(EItemState State) override;
+
+	/** Ticks while falling, moving the slide or spinning on the CPU */
+	virtual bool NeedsTick() const override;
+
+	virtual void RefreshMaterialEffects() override;
+
+	/** Sets the material spin for the current state */
+	void UpdateSpin();
+
+	/** Streams the mesh, material, anim class and pickup sound in, the editor loads them right away */
+	void RequestDisplayAssets();
+	void ApplyDisplayAssets();
+
+	virtual void PrefetchInventoryAssets() override;
+
+	/** A weapon in the inventory needs its display assets too, so they are finished as well */
+	virtual void LoadInventoryAssets() override;
+	void ApplyInventoryAssets();
+
 	void FinishMovingSlide();
 
 	void UpdateSlideDisplacement();
 
-	void RotateWhenOnPickup();
+	/** Spins the weapon when the material can't spin it on its own */
+	void RotateWhenOnPickup(float DeltaTime);
 
 private:
 	FTimerHandle ThrowWeaponTimer;
@@ -245,6 +276,20 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 		float MaxSlideDisplacement;
 
+	/** Yaw rate in degrees per second while waiting to be picked up */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+		float PickupSpinRate;
+
+	/** The material spins the mesh by Spin Rate with its Time node, so the weapon doesn't have to tick for it */
+	bool bMaterialDrivesSpin;
+
+	/** Asset loads in flight */
+	TSharedPtr<FStreamableHandle> DisplayAssetsHandle;
+	TSharedPtr<FStreamableHandle> InventoryAssetsHandle;
+
+	/** Sounds, muzzle flash, crosshairs and icons are set, they are left empty until the weapon is near the player */
+	bool bInventoryAssetsApplied;
+
 	/** Max Rotation for Pistol Recoil */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 		float MaxRecoilRotation;
@@ -294,6 +339,14 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 		float NoiseRange;
 
+	/** Pellets per shot, resolved as one hitscan batch when more than one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+		int32 PelletCount;
+
+	/** Half angle of the pellet cone in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "45"))
+		float PelletSpread;
+
 public:
 	// Add impulse to the weapon
 	void ThrowWeapon();
@@ -333,16 +386,18 @@ public:
 
 	FORCEINLINE float GetNoiseRange() const { return NoiseRange; }
 
+	FORCEINLINE int32 GetPelletCount() const { return PelletCount; }
+	FORCEINLINE float GetPelletSpread() const { return PelletSpread; }
+
 	void StartSlideTimer();
 
 	bool ClipIsFull();
 
-	bool CanCriticalHit();
-	float GetCriticalHit(bool bCanCriticalHit, float NoCritDamage);
-
 	FORCEINLINE float GetRarityBulletTimeModifier() const { return RarityBulletTimeModifier; }
 	FORCEINLINE float GetRarityBulletTimeDilation() const { return RarityBulletTimeDilation; }
 	FORCEINLINE float GetRarityBulletTimeResetMoveSpeed() const { return RarityBulletTimeResetMoveSpeed; }
 	
 	FORCEINLINE int32 GetRarityMaxChainedExecutions() const { return RarityMaxChainedExecutions; }
+	FORCEINLINE int32 GetRarityCriticalChance() const { return RarityCriticalChance; }
+	FORCEINLINE int32 GetRarityCriticalMultiplier() const { return RarityCriticalMultiplier; }
 };
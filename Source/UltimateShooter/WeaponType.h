@@ -6,6 +6,7 @@ enum class EWeaponType : uint8
 	EWT_SubmachineGun UMETA(DisplayName = "SubmachineGun"),
 	EWT_AssaultRifle UMETA(DisplayName = "AssaultRifle"),
 	EWT_Pistol UMETA(DisplayName = "Pistol"),
+	EWT_Shotgun UMETA(DisplayName = "Shotgun"),
 
 	EWT_MAX UMETA(DisplayName = "DefaultMAX")
 };
\ No newline at end of file